@@ -0,0 +1,116 @@
+// Vimerate benchmark harness: timing, the JSON report and the comparison against a baseline report,
+// shared by the Win32 app's --bench and the portable vimerate-bench tool (Tools/VimerateBench.cpp).
+// Plain C++17, no platform headers.
+#pragma once
+
+#include <algorithm> // std::sort / std::min / std::max
+#include <chrono>    // steady_clock
+#include <cmath>     // std::ceil
+#include <cstdint>   // uint8_t
+#include <cstdlib>   // atof
+#include <iomanip>   // std::setprecision
+#include <sstream>   // Report text and baseline lines
+#include <string>    // Scenario names
+#include <utility>   // std::pair
+#include <vector>    // Samples and results
+
+struct BenchResult { std::string name; double medianUs; double minUs; };
+
+// Shortest timed sample: faster scenarios run several times per sample, so timer resolution
+// and scheduler noise don't dominate microsecond-scale results
+const double BENCH_MIN_SAMPLE_US = 2000.0;
+
+// Regression rule defaults: a scenario regressed if its median grew by more than both
+const double BENCH_THRESHOLD_PCT = 10.0; // ... this many percent
+const double BENCH_MIN_DELTA_US = 5.0;   // ... and this many microseconds, so noise on tiny scenarios doesn't fail the run
+const int    BENCH_ITERATIONS = 15;      // Timed samples per scenario
+
+// Microseconds since an arbitrary fixed point (steady_clock is QueryPerformanceCounter on Windows)
+inline double BenchNowUs() {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Time fn() for the given number of samples (after one warm-up run); results are per call
+template <typename Fn>
+BenchResult BenchRun(const std::string& name, int iterations, Fn fn) {
+    fn(); // Warm-up: caches, lazily created objects, buffers reaching their size
+    double t0 = BenchNowUs();
+    fn(); // Calibration: how many calls fill one sample
+    double once = std::max(BenchNowUs() - t0, 0.01);
+    int repeats = (int)std::min(100000.0, std::ceil(BENCH_MIN_SAMPLE_US / once));
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; ++i) {
+        t0 = BenchNowUs();
+        for (int k = 0; k < repeats; ++k) fn();
+        samples.push_back((BenchNowUs() - t0) / repeats);
+    }
+    std::sort(samples.begin(), samples.end());
+    return { name, samples[samples.size() / 2], samples[0] };
+}
+
+// Read "name" -> median_us pairs from a report written by BenchReport (one result per line)
+inline void ParseBenchBaseline(const std::string& text, std::vector<BenchResult>& out) {
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        size_t n = line.find("\"name\": \""), m = line.find("\"median_us\": ");
+        if (n == std::string::npos || m == std::string::npos) continue;
+        n += 9;
+        size_t end = line.find('"', n);
+        if (end == std::string::npos) continue;
+        out.push_back({ line.substr(n, end - n), atof(line.c_str() + m + 13), 0 });
+    }
+}
+
+// The JSON report, one result per line so the baseline reader stays trivial. Results with a
+// baseline entry of the same name carry its median, the change and whether it regressed;
+// 'counters' are extra top-level integers (e.g. allocations). Counts the regressions.
+inline std::string BenchReport(const std::vector<BenchResult>& results, const std::vector<BenchResult>& baseline,
+                               int iterations, double threshold, double minDelta,
+                               const std::vector<std::pair<std::string, long>>& counters, int& regressions) {
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(2);
+    json << "{\n  \"version\": 1,\n  \"iterations\": " << iterations << ",\n  \"results\": [\n";
+    regressions = 0;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        json << "    { \"name\": \"" << r.name << "\", \"median_us\": " << r.medianUs << ", \"min_us\": " << r.minUs;
+        for (const auto& b : baseline) {
+            if (b.name != r.name) continue;
+            double change = b.medianUs > 0 ? (r.medianUs - b.medianUs) * 100.0 / b.medianUs : 0.0;
+            bool regressed = change > threshold && r.medianUs - b.medianUs > minDelta;
+            regressions += regressed ? 1 : 0;
+            json << ", \"baseline_us\": " << b.medianUs << ", \"change_pct\": " << change
+                 << ", \"regressed\": " << (regressed ? "true" : "false");
+            break;
+        }
+        json << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    json << "  ],\n  \"threshold_pct\": " << threshold << ",\n  \"min_delta_us\": " << minDelta
+         << ",\n  \"regressions\": " << regressions;
+    for (const auto& c : counters) json << ",\n  \"" << c.first << "\": " << c.second;
+    json << "\n}\n";
+    return json.str();
+}
+
+// --- Fixtures ---
+
+// Synthetic desktop for the target detector: flat background with rows of bordered buttons
+// carrying glyph-like strokes. Deterministic, so timings compare across runs.
+inline void SyntheticDesktop(std::vector<uint8_t>& px, int w, int h) {
+    px.assign((size_t)w * h * 4, 0xF0);
+    auto fill = [&](int x0, int y0, int x1, int y1, uint8_t v) {
+        for (int y = y0; y < y1; ++y)
+            for (int x = x0; x < x1; ++x) {
+                uint8_t* p = &px[((size_t)y * w + x) * 4];
+                p[0] = p[1] = p[2] = v;
+            }
+    };
+    for (int y = 40; y + 40 < h; y += 90)
+        for (int x = 40; x + 120 < w; x += 160) {
+            fill(x, y, x + 100, y + 28, 0x60);          // Border
+            fill(x + 1, y + 1, x + 99, y + 27, 0xE0);   // Face
+            for (int k = 0; k < 6; ++k)
+                fill(x + 14 + k * 12, y + 9, x + 20 + k * 12, y + 19, 0x20); // Caption strokes
+        }
+}
@@ -0,0 +1,118 @@
+// Vimerate automation commands: the line protocol served by the Win32 named pipe and the X11 Unix
+// socket. Labels resolve on the uniform grid covering an area the frontend passes in; cursor moves
+// and mouse actions go back to the frontend through CommandActions. No platform headers; tested on
+// its own (Tests/CommandsTest.cpp).
+//
+//   resolve L1 L2 ...   -> ok x1 y1 x2 y2 ...
+//   move L              -> ok x y
+//   act L ACTION        -> ok x y     (ACTION: click|right|middle|double|ctrl+click|scroll N down ...)
+//   drag A->B           -> ok
+// Every command gets one reply line, "ok ..." or "err ..."; blank lines get none.
+#pragma once
+
+#include "Grid.h"      // LabelRect
+#include "InputPlan.h" // InputAction, ParseInputAction
+#include <cstdint>     // uint32_t code points
+#include <sstream>     // Command parsing and replies
+#include <string>      // Lines and replies
+
+// What commands do on the frontend's side
+struct CommandActions {
+    void (*move)(POINT pt);                   // Put the cursor at pt
+    void (*perform)(const InputAction& action); // A click or scroll at action.at (moveFirst set), or a drag
+};
+
+// Center of a label's cell on the uniform grid covering 'area' with the given pool size
+inline bool ResolveLabel(const std::wstring& lbl, int poolSize, const RECT& area, POINT& pt) {
+    RECT rc;
+    if (!LabelRect(lbl, poolSize, area, rc)) return false;
+    pt = { (rc.left + rc.right) / 2, (rc.top + rc.bottom) / 2 };
+    return true;
+}
+
+// Execute one command line and append its reply line to 'reply'
+inline void ExecuteCommand(const std::wstring& line, int poolSize, const RECT& area, const CommandActions& actions, std::string& reply) {
+    std::wstringstream ss(line);
+    std::wstring verb;
+    if (!(ss >> verb)) return; // Blank line: no reply
+
+    std::ostringstream out;
+    if (verb == L"resolve") {
+        out << "ok";
+        std::wstring lbl;
+        while (ss >> lbl) {
+            POINT pt;
+            if (!ResolveLabel(lbl, poolSize, area, pt)) { reply += "err unknown label\n"; return; }
+            out << ' ' << pt.x << ' ' << pt.y;
+        }
+    } else if (verb == L"move" || verb == L"act") {
+        std::wstring lbl, rest;
+        POINT pt;
+        if (!(ss >> lbl) || !ResolveLabel(lbl, poolSize, area, pt)) { reply += "err unknown label\n"; return; }
+        if (verb == L"move") {
+            actions.move(pt);
+        } else {
+            std::getline(ss, rest);
+            InputAction action;
+            std::wstring fromLbl, toLbl;
+            if (!ParseInputAction(rest, action, fromLbl, toLbl) || action.kind == ACT_DRAG) { reply += "err bad action\n"; return; }
+            action.moveFirst = true; // Move and act in one batch
+            action.at = pt;
+            actions.perform(action);
+        }
+        out << "ok " << pt.x << ' ' << pt.y;
+    } else if (verb == L"drag") {
+        InputAction action;
+        std::wstring fromLbl, toLbl;
+        if (!ParseInputAction(line, action, fromLbl, toLbl) ||
+            !ResolveLabel(fromLbl, poolSize, area, action.from) || !ResolveLabel(toLbl, poolSize, area, action.to)) {
+            reply += "err bad drag\n";
+            return;
+        }
+        actions.perform(action);
+        out << "ok";
+    } else {
+        out << "err unknown command";
+    }
+    reply += out.str() + "\n";
+}
+
+// UTF-8 bytes as a wide string (UTF-16 where wchar_t is 16 bits); malformed bytes become U+FFFD
+inline std::wstring Utf8ToWide(const std::string& s) {
+    std::wstring out;
+    for (size_t i = 0; i < s.size(); ) {
+        unsigned char b = (unsigned char)s[i];
+        int extra = b < 0x80 ? 0 : (b >> 5) == 6 ? 1 : (b >> 4) == 14 ? 2 : (b >> 3) == 30 ? 3 : -1;
+        uint32_t cp = extra == 0 ? b : extra == 1 ? (b & 0x1F) : extra == 2 ? (b & 0x0F) : (b & 0x07);
+        bool ok = extra >= 0 && i + extra < s.size();
+        for (int k = 1; ok && k <= extra; ++k) {
+            unsigned char c = (unsigned char)s[i + k];
+            ok = (c >> 6) == 2;
+            cp = cp << 6 | (c & 0x3F);
+        }
+        if (!ok || cp > 0x10FFFF) { out += (wchar_t)0xFFFD; ++i; continue; }
+        i += extra + 1;
+        if (sizeof(wchar_t) == 2 && cp > 0xFFFF) { // Surrogate pair
+            cp -= 0x10000;
+            out += (wchar_t)(0xD800 + (cp >> 10));
+            out += (wchar_t)(0xDC00 + (cp & 0x3FF));
+        } else {
+            out += (wchar_t)cp;
+        }
+    }
+    return out;
+}
+
+// Execute every complete line in 'pending' (bytes a client sent, UTF-8, LF or CRLF endings) and
+// append their replies; an unfinished last line stays in 'pending' for the next read. A server
+// writes 'reply' back once per read, so a batch of commands costs one write.
+inline void ExecuteCommandBatch(std::string& pending, int poolSize, const RECT& area, const CommandActions& actions, std::string& reply) {
+    size_t start = 0, nl;
+    while ((nl = pending.find('\n', start)) != std::string::npos) {
+        std::string cmd = pending.substr(start, nl - start);
+        if (!cmd.empty() && cmd.back() == '\r') cmd.pop_back();
+        ExecuteCommand(Utf8ToWide(cmd), poolSize, area, actions, reply);
+        start = nl + 1;
+    }
+    pending.erase(0, start);
+}
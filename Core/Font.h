@@ -0,0 +1,200 @@
+// Vimerate built-in font: 5x9 bitmap glyphs drawn at an integer scale, so text has no font engine
+// dependency and looks the same on every machine, plus the label box metrics built on it. No
+// platform headers; shared by every frontend and tested on its own (Tests/FontTest.cpp).
+#pragma once
+
+#include <algorithm> // std::min / std::max
+#include <cmath>     // std::sqrt / std::lround
+#include <cstddef>   // size_t
+#include <cstdint>   // Fixed-width integers
+
+const int FONT_GLYPH_W = 5;        // Glyph cell width in font pixels
+const int FONT_GLYPH_H = 9;        // Glyph cell height: 7 rows to the baseline, 2 for descenders
+const int FONT_SPACE_ADVANCE = 3;  // Width of ' ' in font pixels
+const int FONT_MAX_SCALE = 8;      // Screen pixels per font pixel, at most
+
+// One byte per glyph row, bit 4 = leftmost column. Glyphs are proportional: only the columns a
+// glyph uses are drawn, followed by the spacing from GlyphGap.
+const uint8_t FONT_GLYPHS[][FONT_GLYPH_H] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ' '
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00 }, // '.' (one pixel, kerned tight: see GlyphGap)
+    { 0x01, 0x01, 0x02, 0x04, 0x08, 0x10, 0x10, 0x00, 0x00 }, // '/'
+    { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x00 }, // '='
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E, 0x00, 0x00 }, // '0'
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00, 0x00 }, // '1'
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F, 0x00, 0x00 }, // '2'
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E, 0x00, 0x00 }, // '3'
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02, 0x00, 0x00 }, // '4'
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E, 0x00, 0x00 }, // '5'
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E, 0x00, 0x00 }, // '6'
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08, 0x00, 0x00 }, // '7'
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E, 0x00, 0x00 }, // '8'
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C, 0x00, 0x00 }, // '9'
+    { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11, 0x00, 0x00 }, // 'A'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E, 0x00, 0x00 }, // 'B'
+    { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E, 0x00, 0x00 }, // 'C'
+    { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C, 0x00, 0x00 }, // 'D'
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F, 0x00, 0x00 }, // 'E'
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10, 0x00, 0x00 }, // 'F'
+    { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F, 0x00, 0x00 }, // 'G'
+    { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11, 0x00, 0x00 }, // 'H'
+    { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00, 0x00 }, // 'I'
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C, 0x00, 0x00 }, // 'J'
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11, 0x00, 0x00 }, // 'K'
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F, 0x00, 0x00 }, // 'L'
+    { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11, 0x00, 0x00 }, // 'M'
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11, 0x00, 0x00 }, // 'N'
+    { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00, 0x00 }, // 'O'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10, 0x00, 0x00 }, // 'P'
+    { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D, 0x00, 0x00 }, // 'Q'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11, 0x00, 0x00 }, // 'R'
+    { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E, 0x00, 0x00 }, // 'S'
+    { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00 }, // 'T'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00, 0x00 }, // 'U'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04, 0x00, 0x00 }, // 'V'
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A, 0x00, 0x00 }, // 'W'
+    { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11, 0x00, 0x00 }, // 'X'
+    { 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00 }, // 'Y'
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F, 0x00, 0x00 }, // 'Z'
+    { 0x00, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00, 0x00 }, // 'a'
+    { 0x10, 0x10, 0x1E, 0x11, 0x11, 0x11, 0x1E, 0x00, 0x00 }, // 'b'
+    { 0x00, 0x00, 0x0F, 0x10, 0x10, 0x10, 0x0F, 0x00, 0x00 }, // 'c'
+    { 0x01, 0x01, 0x0F, 0x11, 0x11, 0x11, 0x0F, 0x00, 0x00 }, // 'd'
+    { 0x00, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0E, 0x00, 0x00 }, // 'e'
+    { 0x06, 0x08, 0x1E, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00 }, // 'f'
+    { 0x00, 0x00, 0x0F, 0x11, 0x11, 0x11, 0x0F, 0x01, 0x0E }, // 'g'
+    { 0x10, 0x10, 0x1E, 0x11, 0x11, 0x11, 0x11, 0x00, 0x00 }, // 'h'
+    { 0x04, 0x00, 0x0C, 0x04, 0x04, 0x04, 0x0E, 0x00, 0x00 }, // 'i'
+    { 0x02, 0x00, 0x06, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C }, // 'j'
+    { 0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12, 0x00, 0x00 }, // 'k'
+    { 0x0C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00, 0x00 }, // 'l'
+    { 0x00, 0x00, 0x1A, 0x15, 0x15, 0x15, 0x15, 0x00, 0x00 }, // 'm'
+    { 0x00, 0x00, 0x1E, 0x11, 0x11, 0x11, 0x11, 0x00, 0x00 }, // 'n'
+    { 0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00, 0x00 }, // 'o'
+    { 0x00, 0x00, 0x1E, 0x11, 0x11, 0x11, 0x1E, 0x10, 0x10 }, // 'p'
+    { 0x00, 0x00, 0x0F, 0x11, 0x11, 0x11, 0x0F, 0x01, 0x01 }, // 'q'
+    { 0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10, 0x00, 0x00 }, // 'r'
+    { 0x00, 0x00, 0x0F, 0x10, 0x0E, 0x01, 0x1E, 0x00, 0x00 }, // 's'
+    { 0x08, 0x08, 0x1E, 0x08, 0x08, 0x09, 0x06, 0x00, 0x00 }, // 't'
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D, 0x00, 0x00 }, // 'u'
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04, 0x00, 0x00 }, // 'v'
+    { 0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A, 0x00, 0x00 }, // 'w'
+    { 0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x00, 0x00 }, // 'x'
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x11, 0x0F, 0x01, 0x0E }, // 'y'
+    { 0x00, 0x00, 0x1F, 0x02, 0x04, 0x08, 0x1F, 0x00, 0x00 }, // 'z'
+};
+
+// Glyph of a character: ' ', '.', '/', '=', digits, then upper and lower case letters (-1 if none)
+inline int GlyphIndex(wchar_t ch) {
+    if (ch == L' ') return 0;
+    if (ch == L'.') return 1;
+    if (ch == L'/') return 2;
+    if (ch == L'=') return 3;
+    if (ch >= L'0' && ch <= L'9') return 4 + (ch - L'0');
+    if (ch >= L'A' && ch <= L'Z') return 14 + (ch - L'A');
+    if (ch >= L'a' && ch <= L'z') return 40 + (ch - L'a');
+    return -1;
+}
+
+// Columns a glyph uses, [c0, c1]; blank glyphs (space, unknown) span FONT_SPACE_ADVANCE columns
+inline void GlyphSpan(int g, int& c0, int& c1) {
+    uint8_t used = 0;
+    if (g >= 0) for (int r = 0; r < FONT_GLYPH_H; ++r) used |= FONT_GLYPHS[g][r];
+    if (!used) { c0 = 0; c1 = FONT_SPACE_ADVANCE - 1; return; }
+    c0 = 0;
+    while (!(used & (0x10 >> c0))) ++c0;
+    c1 = FONT_GLYPH_W - 1;
+    while (!(used & (0x10 >> c1))) --c1;
+}
+
+// Screen pixels between two glyphs: one font pixel, but half of one next to a '.', so a dotted
+// label is barely wider than a plain one ('b' is 0 after the last glyph)
+inline int GlyphGap(wchar_t a, wchar_t b, int scale) {
+    if (!b) return 0;
+    return (a == L'.' || b == L'.') ? (scale + 1) / 2 : scale;
+}
+
+// Width in pixels of a line of text at 'scale' screen pixels per font pixel, emboldened by 'bold' pixels
+inline int TextWidth(const wchar_t* text, int scale, int bold) {
+    int width = 0;
+    for (const wchar_t* p = text; *p; ++p) {
+        int c0, c1;
+        GlyphSpan(GlyphIndex(*p), c0, c1);
+        width += (c1 - c0 + 1) * scale + GlyphGap(p[0], p[1], scale);
+    }
+    return width + (width ? bold : 0);
+}
+
+// Draw a line of text as 0/255 coverage into an 8-bit mask ('step' bytes per pixel, w x h, clipped),
+// top-left of the glyph cells at (x, y). Bold widens every stroke by 'bold' pixels to the right.
+inline void RasterizeText(const wchar_t* text, int scale, int bold, uint8_t* mask, int step, int stride, int w, int h, int x, int y) {
+    for (const wchar_t* p = text; *p; ++p) {
+        int g = GlyphIndex(*p), c0, c1;
+        GlyphSpan(g, c0, c1);
+        for (int r = 0; g >= 0 && r < FONT_GLYPH_H; ++r)
+            for (int c = c0; c <= c1; ++c) {
+                if (!(FONT_GLYPHS[g][r] & (0x10 >> c))) continue;
+                int px0 = std::max(0, x + (c - c0) * scale), px1 = std::min(w, x + (c - c0 + 1) * scale + bold);
+                int py0 = std::max(0, y + r * scale), py1 = std::min(h, y + (r + 1) * scale);
+                for (int py = py0; py < py1; ++py)
+                    for (int px = px0; px < px1; ++px) mask[(size_t)py * stride + (size_t)px * step] = 255;
+            }
+        x += (c1 - c0 + 1) * scale + GlyphGap(p[0], p[1], scale); // Glyph plus spacing
+    }
+}
+
+// Coverage of a w x h rectangle with corners rounded to 'radius' ('step' bytes per pixel). Straight
+// edges are fully covered; corner pixels get coverage from their center's distance to the arc.
+inline void RoundedBoxMask(uint8_t* mask, int step, int stride, int w, int h, float radius) {
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x) {
+            float cx = x + 0.5f, cy = y + 0.5f; // Pixel center
+            float dx = std::max(0.0f, std::max(radius - cx, cx - (w - radius))); // Distance into a corner square
+            float dy = std::max(0.0f, std::max(radius - cy, cy - (h - radius)));
+            float cover = 1.0f;
+            if (dx > 0 && dy > 0) cover = std::max(0.0f, std::min(1.0f, radius - std::sqrt(dx * dx + dy * dy) + 0.5f));
+            mask[(size_t)y * stride + (size_t)x * step] = (uint8_t)std::lround(cover * 255);
+        }
+}
+
+// Screen pixels per font pixel for labels at a DPI: 2 at 96 DPI
+inline int FontScale(unsigned dpi) {
+    return std::max(1, std::min((int)((dpi * 2 + 48) / 96), FONT_MAX_SCALE));
+}
+
+// --- Label boxes ---
+// At 96 DPI the widest label, dotted included, must fit the default cell: a 1920 pixel wide screen
+// split into 2 x 36 columns, 26 pixels. So bold starts at scale 3 (at 2 it would widen 2 pixel
+// strokes by half), and the text inset is one pixel until scale 4.
+struct LabelStyle { int bold, padX, padY; };
+inline LabelStyle LabelStyleFor(int scale) {
+    return { scale / 3, std::max(1, scale / 2), std::max(1, scale / 2) };
+}
+inline int LabelBoxWidth(const wchar_t* label, int scale) {
+    return TextWidth(label, scale, LabelStyleFor(scale).bold) + 2 * LabelStyleFor(scale).padX;
+}
+inline int LabelBoxHeight(int scale) {
+    return FONT_GLYPH_H * scale + 2 * LabelStyleFor(scale).padY;
+}
+
+// Interleaved (box, text) coverage of a label into zeroed masks, 2 bytes per pixel and 'stride'
+// bytes per row: the rounded box at the top-left, the text inset by the label style (an atlas tile)
+inline void RasterizeLabel(const wchar_t* label, int scale, uint8_t* masks, int stride) {
+    LabelStyle style = LabelStyleFor(scale);
+    int bw = LabelBoxWidth(label, scale), bh = LabelBoxHeight(scale);
+    RoundedBoxMask(masks, 2, stride, bw, bh, (float)scale);
+    RasterizeText(label, scale, style.bold, masks + 1, 2, stride, bw, bh, style.padX, style.padY);
+}
+
+// --- Click prompt ---
+const int PROMPT_PAD_X = 6; // Text indent on each side
+const int PROMPT_PAD_Y = 8; // Space above and below the text
+inline int PromptBoxWidth(const wchar_t* text, int scale) { return TextWidth(text, scale, 0) + 2 * PROMPT_PAD_X; }
+inline int PromptBoxHeight(int scale) { return FONT_GLYPH_H * scale + 2 * PROMPT_PAD_Y; }
+
+// Interleaved (box, text) coverage of a w x h prompt into zeroed masks: a rounded box with the
+// text indented and centered vertically
+inline void RasterizePrompt(const wchar_t* text, int scale, uint8_t* masks, int w, int h) {
+    RoundedBoxMask(masks, 2, w * 2, w, h, 2.0f);
+    RasterizeText(text, scale, 0, masks + 1, 2, w * 2, w, h, PROMPT_PAD_X, (h - FONT_GLYPH_H * scale) / 2);
+}
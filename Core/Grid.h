@@ -0,0 +1,300 @@
+// Vimerate grid model and key handling: the label alphabet, which label sits in which cell, cell
+// geometry (uniform or foveated), click prompt placement, and the state machine that turns keys
+// into jumps and mouse actions. No platform headers; shared by the Win32 and X11 frontends and
+// tested on its own (Tests/GridTest.cpp).
+#pragma once
+
+#include "Font.h"      // Prompt metrics
+#include "InputPlan.h" // InputAction for prompt keys and drags
+#include "Platform.h"  // POINT, RECT, LONG
+#include <algorithm>   // std::min / std::max
+#include <cmath>       // std::erf for foveated edges
+#include <cwctype>     // towlower
+#include <string>      // Labels and typed input
+#include <vector>      // Row and column edges
+
+const std::wstring POOL = L"abcdefghijklmnopqrstuvwxyz0123456789"; // Character pool
+const int MIN_POOL_SIZE = 6;   // Minimum characters allowed in pool
+const int SCROLL_NOTCHES = 3;  // Wheel notches per scroll key in WAIT_CLICK
+const wchar_t PROMPT_TEXT[] = L"1=Left 2=Right 3=Double d=Drag j/k=Scroll"; // Click prompt
+
+// Foveated layout: cells near the focus are up to FOVEA_MAX_ZOOM times smaller than uniform ones,
+// but never smaller than a label box; the label budget is unchanged, outer cells grow to pay for it.
+const double FOVEA_MAX_ZOOM = 3.0;   // Largest uniform-to-focus cell size ratio
+const double FOVEA_SIGMA = 0.15;     // Width of the dense region, as a fraction of the axis
+const int    FOVEA_MIN_CELL_W = 28;  // Narrowest cell in pixels (dotted labels fit at 96 DPI)
+const int    FOVEA_MIN_CELL_H = 20;  // Lowest cell in pixels
+
+// --- Cells ---
+// A grid with pool size n has n rows and 2n columns. Cells are numbered row by row; within a row,
+// each plain label ("ab") is followed by its dotted twin ("a.b"), and dotted labels sit in the
+// right half of the row.
+
+inline size_t GridCellCount(int poolSize) { return (size_t)poolSize * poolSize * 2; }
+
+// Label of cell i into 'out' (at least 4 characters, terminated); returns its length
+inline int CellLabel(size_t i, int poolSize, wchar_t* out) {
+    wchar_t first = POOL[i / 2 / poolSize], second = POOL[i / 2 % poolSize];
+    out[0] = first;
+    if (i & 1) { out[1] = L'.'; out[2] = second; out[3] = L'\0'; return 3; }
+    out[1] = second; out[2] = L'\0';
+    return 2;
+}
+
+// Grid row and column of cell i
+inline void CellPosition(size_t i, int poolSize, size_t& row, size_t& col) {
+    size_t cols = (size_t)poolSize * 2;
+    row = i / cols;
+    col = (i % cols) / 2 + ((i & 1) ? poolSize : 0); // Dotted labels sit in the right half
+}
+
+// Cell rectangle for a label on a grid covering 'area' with the given pool size (pure geometry, no globals)
+inline bool LabelRect(const std::wstring& lbl, int poolSize, const RECT& area, RECT& rc) {
+    int rows = poolSize; // Number of rows in grid
+    int cols = poolSize * 2; // Double columns (normal + dotted)
+    float cellW = (float)(area.right - area.left) / cols; // Cell width
+    float cellH = (float)(area.bottom - area.top) / rows; // Cell height
+
+    size_t col; // Column of the second char; dotted labels sit in the right half
+    if (lbl.length() == 2) col = POOL.find(lbl[1]); // Normal two-char label
+    else if (lbl.length() == 3 && lbl[1] == L'.') col = POOL.find(lbl[2]); // Dotted label
+    else return false;
+    size_t row = lbl.empty() ? std::wstring::npos : POOL.find(lbl[0]); // Row of the first char
+    if (row >= (size_t)poolSize || col >= (size_t)poolSize) return false; // Not in the current pool
+
+    if (lbl.length() == 3) col += poolSize; // Shifted for right column
+    rc = {
+        area.left + LONG(col * cellW), // X position
+        area.top + LONG(row * cellH), // Y position
+        area.left + LONG((col + 1) * cellW), // Right edge
+        area.top + LONG((row + 1) * cellH) // Bottom edge
+    };
+    return true;
+}
+
+// Boundaries of 'count' cells along [lo, hi). Uniform cells use LabelRect's rounding. Foveated cells
+// each take an equal share of the density 1 + A * exp(-((x - focus) / sigma)^2), so they shrink near
+// the focus and grow away from it; A makes the focus cell 'zoom' times smaller than a uniform one.
+// Edges invert the density's closed-form integral by bisection: O(count) per axis.
+inline void AxisEdges(LONG lo, LONG hi, int count, const LONG* focus, int minCell, std::vector<LONG>& edges) {
+    edges.resize(count + 1); // Keeps capacity: no allocation per keystroke
+    double len = hi - lo;
+    double zoom = focus ? std::min(FOVEA_MAX_ZOOM, len / count / minCell) : 1.0;
+    double sigma = len * FOVEA_SIGMA;
+    double c = focus ? std::max(0.0, std::min(len, (double)(*focus - lo))) : 0; // Focus offset, inside the axis
+    double k = sigma * 0.886226925452758; // sqrt(pi) / 2: the Gaussian integrates to k * erf
+    auto bump = [&](double x) { return k * (std::erf((x - c) / sigma) - std::erf(-c / sigma)); }; // Integral over [0, x]
+    double amp = zoom > 1.0 ? (zoom - 1) / (1 - zoom * bump(len) / len) : 0; // Peak density / mean density = zoom
+    if (!(amp > 0)) { // Uniform
+        float cell = (float)(hi - lo) / count;
+        for (int i = 0; i <= count; ++i) edges[i] = lo + LONG(i * cell);
+        return;
+    }
+    double total = len + amp * bump(len), x = 0;
+    edges[0] = lo;
+    for (int i = 1; i < count; ++i) {
+        double target = total * i / count, a = x, b = len; // Edges only move right: search past the last one
+        for (int it = 0; it < 32; ++it) {
+            double m = (a + b) / 2;
+            (m + amp * bump(m) < target ? a : b) = m;
+        }
+        x = (a + b) / 2;
+        edges[i] = lo + LONG(x + 0.5);
+    }
+    edges[count] = hi;
+}
+
+// Row and column boundaries for a grid covering 'area' (pure geometry, no globals). A null focus
+// gives the uniform grid LabelRect describes; otherwise cells shrink around the focus point.
+inline void GridEdges(const RECT& area, int poolSize, const POINT* focus, std::vector<LONG>& rowEdges, std::vector<LONG>& colEdges) {
+    AxisEdges(area.top, area.bottom, poolSize, focus ? &focus->y : nullptr, FOVEA_MIN_CELL_H, rowEdges);
+    AxisEdges(area.left, area.right, poolSize * 2, focus ? &focus->x : nullptr, FOVEA_MIN_CELL_W, colEdges);
+}
+
+// --- Cell lists ---
+// Each frontend keeps its own cell type; these need its 'lbl' (std::wstring), 'rc' and 'pt'. Both
+// run on every keystroke, so they only reuse the capacity of what they fill.
+
+// The cells whose labels start with 'typed' (all of them when nothing is typed), in cell order
+template <class CellT>
+inline void FilterByPrefix(std::vector<CellT>& cells, const std::wstring& typed, std::vector<CellT*>& out) {
+    out.clear();
+    for (auto& c : cells)
+        if (c.lbl.compare(0, typed.length(), typed) == 0) out.push_back(&c);
+}
+
+// Lay out cells in CellLabel order on a grid covering 'area' (GridEdges), each jumping to its center
+template <class CellT>
+inline void LayoutGrid(std::vector<CellT>& cells, const RECT& area, int poolSize, const POINT* focus,
+                       std::vector<LONG>& rowEdges, std::vector<LONG>& colEdges) {
+    GridEdges(area, poolSize, focus, rowEdges, colEdges);
+    for (size_t i = 0; i < cells.size(); ++i) {
+        size_t row, col;
+        CellPosition(i, poolSize, row, col);
+        CellT& c = cells[i];
+        c.rc = { colEdges[col], rowEdges[row], colEdges[col + 1], rowEdges[row + 1] };
+        c.pt = { (c.rc.left + c.rc.right) / 2, (c.rc.top + c.rc.bottom) / 2 }; // Jump to the center
+    }
+}
+
+// Widest label box on a grid with the given pool size, dotted labels included
+inline int MaxLabelBoxWidth(int poolSize, int scale) {
+    int w = 0;
+    wchar_t lbl[4];
+    for (size_t i = 0; i < GridCellCount(poolSize); ++i) {
+        CellLabel(i, poolSize, lbl);
+        w = std::max(w, LabelBoxWidth(lbl, scale));
+    }
+    return w;
+}
+
+// Whether every uniform cell of a grid covering 'area' holds its label box, so no label spills into
+// its neighbors. LabelRect's rounding makes no cell narrower or lower than the integer quotient.
+inline bool GridFits(const RECT& area, int poolSize, int scale) {
+    return (area.bottom - area.top) / poolSize >= LabelBoxHeight(scale) &&
+           (area.right - area.left) / (poolSize * 2) >= MaxLabelBoxWidth(poolSize, scale);
+}
+
+// Largest pool size up to 'maxPool' whose grid fits 'area', or 0 if even MIN_POOL_SIZE doesn't.
+// Fewer characters mean larger cells and no wider labels, so the fit is monotonic: bisect.
+inline int FittingPool(const RECT& area, int maxPool, int scale) {
+    if (maxPool < MIN_POOL_SIZE || !GridFits(area, MIN_POOL_SIZE, scale)) return 0;
+    int lo = MIN_POOL_SIZE, hi = maxPool; // lo fits
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (GridFits(area, mid, scale)) lo = mid; else hi = mid - 1;
+    }
+    return lo;
+}
+
+// Place the click prompt next to a cell: right of it, or left if it would leave the grid area
+inline RECT PromptRect(const RECT& rc, const RECT& area, int scale) {
+    int promptMargin = 8; // Margin for prompt box
+    int promptWidth = PromptBoxWidth(PROMPT_TEXT, scale);
+    int promptHeight = PromptBoxHeight(scale);
+
+    LONG px = rc.right + promptMargin; // Prompt X position (right of cell)
+    LONG py = rc.top + ((rc.bottom - rc.top) / 2) - (promptHeight / 2); // Prompt Y position (centered)
+
+    if (px + promptWidth > area.right) { // If prompt goes off the area's right edge
+        px = rc.left - promptWidth - promptMargin; // Move to left of cell
+        if (px < area.left) px = area.left; // Clamp to left edge
+    }
+    if (py < area.top) py = area.top; // Clamp to top edge
+    if (py + promptHeight > area.bottom) py = area.bottom - promptHeight; // Clamp to bottom edge
+    return { px, py, px + promptWidth, py + promptHeight };
+}
+
+// --- Key handling ---
+
+enum GridState { HIDDEN, SHOW_ALL, WAIT_CLICK }; // Grid display state
+
+// Keys the grid reacts to, translated by each frontend from its own key events. At the click
+// prompt, letters and digits come by key position (GKEY_CHAR with the unshifted character);
+// while typing, GKEY_CHAR carries the character the key produces.
+enum GridKey { GKEY_OTHER, GKEY_CHAR, GKEY_ESCAPE, GKEY_BACKSPACE, GKEY_LEFT, GKEY_RIGHT, GKEY_UP, GKEY_DOWN,
+               GKEY_ZOOM_IN, GKEY_ZOOM_OUT };
+
+// What the frontend does after a key. The session has already moved to its next state.
+enum GridStep {
+    STEP_NONE,       // Nothing changed
+    STEP_HIDE,       // Hide the overlay
+    STEP_FILTER,     // The typed prefix changed: filter and redraw
+    STEP_LOOKUP,     // The typed text is as long as a label: find its cell and Select it, else filter and redraw
+    STEP_ACT,        // Perform 'action' (a click, or a drag from Select), then hide the overlay
+    STEP_SCROLL,     // Perform 'action' at the cursor and keep the prompt open
+    STEP_NUDGE,      // Move the cursor by (dx, dy)
+    STEP_ZOOM,       // Change the magnifier zoom by dx steps
+    STEP_DRAG_START, // Store the cursor in dragFrom; the full grid is back to pick the drop point
+    STEP_PROMPT      // Move the cursor to the selected cell and open the click prompt
+};
+struct GridResult {
+    GridStep    step = STEP_NONE;
+    InputAction action;     // For STEP_ACT and STEP_SCROLL
+    int         dx = 0, dy = 0; // For STEP_NUDGE and STEP_ZOOM
+};
+
+// One activation of the grid: what is shown, what has been typed, and a drag waiting for its drop point
+struct GridSession {
+    GridState    state = HIDDEN;
+    std::wstring typed;               // User's typed input string
+    bool         dragPending = false; // Next selected label is a drop target
+    POINT        dragFrom = { 0, 0 }; // Cursor position where the drag starts
+
+    // Hotkey: the full grid, nothing typed, any abandoned drag forgotten
+    void Show() {
+        state = SHOW_ALL;
+        typed.clear();
+        dragPending = false;
+    }
+
+    GridResult Key(GridKey key, wchar_t ch) {
+        GridResult r;
+        if (state == HIDDEN) return r;
+        if (key == GKEY_ESCAPE) { state = HIDDEN; r.step = STEP_HIDE; return r; }
+        if (state == WAIT_CLICK) return PromptKey(key, ch);
+
+        if (key == GKEY_BACKSPACE) {
+            if (typed.empty()) { state = HIDDEN; r.step = STEP_HIDE; return r; } // Nothing to erase: close
+            typed.pop_back();
+            r.step = STEP_FILTER;
+        } else if (key == GKEY_CHAR && (POOL.find(ch) != std::wstring::npos || ch == L'.')) {
+            typed += ch;
+            r.step = (typed.length() == 2 || typed.length() == 3) ? STEP_LOOKUP : STEP_FILTER;
+        }
+        return r;
+    }
+
+    // The typed label matched a cell whose jump target is 'target': the click prompt there, or
+    // the drop point of a pending drag
+    GridResult Select(POINT target) {
+        GridResult r;
+        if (dragPending) {
+            r.action.kind = ACT_DRAG;
+            r.action.from = dragFrom;
+            r.action.to = target;
+            dragPending = false;
+            state = HIDDEN;
+            r.step = STEP_ACT;
+        } else {
+            state = WAIT_CLICK;
+            r.step = STEP_PROMPT;
+        }
+        return r;
+    }
+
+private:
+    // Click prompt keys; anything unrecognized closes the grid without acting
+    GridResult PromptKey(GridKey key, wchar_t ch) {
+        GridResult r;
+        ch = (wchar_t)towlower(ch);
+        if (key == GKEY_LEFT || key == GKEY_RIGHT || key == GKEY_UP || key == GKEY_DOWN) { // Nudge by one pixel
+            r.dx = (key == GKEY_RIGHT) - (key == GKEY_LEFT);
+            r.dy = (key == GKEY_DOWN) - (key == GKEY_UP);
+            r.step = STEP_NUDGE;
+        } else if (key == GKEY_ZOOM_IN || key == GKEY_ZOOM_OUT) {
+            r.dx = key == GKEY_ZOOM_IN ? 1 : -1;
+            r.step = STEP_ZOOM;
+        } else if (key == GKEY_CHAR && (ch == L'j' || ch == L'k')) { // Scroll down/up, keep the prompt open
+            r.action.kind = ACT_SCROLL;
+            r.action.notches = ch == L'k' ? SCROLL_NOTCHES : -SCROLL_NOTCHES;
+            r.step = STEP_SCROLL;
+        } else if (key == GKEY_CHAR && ch == L'd') { // Pick the drop point with another label
+            dragPending = true;
+            state = SHOW_ALL;
+            typed.clear();
+            r.step = STEP_DRAG_START;
+        } else {
+            if (key == GKEY_CHAR && ch >= L'1' && ch <= L'4') {
+                if (ch == L'2') r.action.button = BTN_RIGHT;
+                else if (ch == L'3') r.action.clicks = 2; // Double left click in one batch
+                else if (ch == L'4') r.action.button = BTN_MIDDLE;
+                r.step = STEP_ACT;
+            } else {
+                r.step = STEP_HIDE;
+            }
+            state = HIDDEN;
+        }
+        return r;
+    }
+};
@@ -0,0 +1,41 @@
+// Vimerate frame handoff: a lock-free triple buffer between one producer thread (input) and one
+// consumer thread (rendering). Plain C++ atomics, no platform headers; the Win32 frontend hands its
+// frame requests over with it, and Tests/HandoffTest.cpp runs it under contention.
+#pragma once
+
+#include <atomic>  // The shared slot
+#include <cstdint> // uintptr_t
+
+// Three slots: the producer fills its own and swaps it into the shared one with the FRESH bit set;
+// the consumer swaps its own slot in only when the bit is set. Neither side ever waits, a newer
+// value silently replaces one that was never taken, and each slot is touched by exactly one thread
+// at a time. Slots keep their contents (and capacity) when they change hands.
+template <class T>
+struct Handoff {
+    static_assert(alignof(T) >= 2, "the low pointer bit carries FRESH");
+    static const uintptr_t FRESH = 1;
+
+    T  slots[3];
+    T* producer = &slots[0]; // Owned by the producer thread: fill it, then Publish
+    T* consumer = &slots[1]; // Owned by the consumer thread: valid after Take returns true
+    std::atomic<uintptr_t> latest{ (uintptr_t)&slots[2] }; // Shared slot; low bit = not yet taken
+
+    Handoff() = default;
+    Handoff(const Handoff&) = delete; // The slot pointers point into the object itself
+    Handoff& operator=(const Handoff&) = delete;
+
+    // Producer: publish 'producer' and take back whichever slot it replaced (taken or superseded).
+    // Release makes the slot's contents visible to the consumer that acquires it.
+    void Publish() {
+        uintptr_t prev = latest.exchange((uintptr_t)producer | FRESH, std::memory_order_acq_rel);
+        producer = (T*)(prev & ~FRESH);
+    }
+
+    // Consumer: swap in the newest published slot, if there is one it hasn't taken
+    bool Take() {
+        if (!(latest.load(std::memory_order_relaxed) & FRESH)) return false; // Only the producer sets the bit
+        uintptr_t prev = latest.exchange((uintptr_t)consumer, std::memory_order_acq_rel);
+        consumer = (T*)(prev & ~FRESH);
+        return true;
+    }
+};
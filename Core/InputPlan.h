@@ -0,0 +1,156 @@
+// Vimerate input planner: turns one mouse action (click, scroll or drag, with held modifiers) into
+// the exact sequence of input events to deliver, with the pause before each one. The plan is plain
+// data; each frontend translates it to its own injection API (SendInput on Windows), so the
+// sequencing and timing are shared and tested on their own (Tests/InputPlanTest.cpp).
+#pragma once
+
+#include "Platform.h" // POINT, UINT, MOD_*
+#include <algorithm>  // std::transform
+#include <cstdlib>    // std::abs
+#include <cwctype>    // towlower
+#include <sstream>    // Command parsing
+#include <string>     // Commands and labels
+#include <vector>     // Planned events
+
+enum ActionKind  { ACT_CLICK, ACT_SCROLL, ACT_DRAG };  // What the action does
+enum ClickButton { BTN_LEFT, BTN_RIGHT, BTN_MIDDLE };  // Which mouse button it uses
+struct InputAction {
+    ActionKind  kind = ACT_CLICK;   // Action type
+    ClickButton button = BTN_LEFT;  // Button for clicks and drags
+    int         clicks = 1;         // Click count (2 = double click)
+    int         notches = 0;        // Wheel notches for scrolling (positive = up/right)
+    bool        horizontal = false; // Scroll horizontally instead of vertically
+    UINT        modifiers = 0;      // MOD_CONTROL/MOD_SHIFT/MOD_ALT/MOD_WIN held during the action
+    POINT       from = { 0, 0 };    // Drag start (screen coordinates)
+    POINT       to = { 0, 0 };      // Drag end (screen coordinates)
+    bool        moveFirst = false;  // Move the cursor to 'at' as part of the same batch
+    POINT       at = { 0, 0 };      // Target for clicks and scrolls when moveFirst is set
+};
+
+// Drags are paced: applications start a drag from a press followed by movement over time, and many
+// ignore a press, moves and release that all arrive at once
+const int DRAG_STEPS = 8;             // Intermediate moves emitted while dragging
+const int DRAG_PRESS_DELAY_MS = 50;   // Pause after the press, before the first move
+const int DRAG_STEP_DELAY_MS = 10;    // Pause before each further move
+const int DRAG_RELEASE_DELAY_MS = 50; // Pause at the drop point, before the release
+
+enum InputEventType { EV_MOVE, EV_BUTTON_DOWN, EV_BUTTON_UP, EV_WHEEL, EV_KEY_DOWN, EV_KEY_UP };
+struct InputEvent {
+    InputEventType type;
+    int            delayMs;    // Pause before this event; events without one are delivered together
+    POINT          pt;         // EV_MOVE: absolute screen point
+    ClickButton    button;     // EV_BUTTON_*
+    int            notches;    // EV_WHEEL: +1 or -1 (positive = up/right)
+    bool           horizontal; // EV_WHEEL: horizontal wheel
+    UINT           modifier;   // EV_KEY_*: one MOD_* flag
+};
+
+inline void PushEvent(std::vector<InputEvent>& out, InputEventType type, int delayMs = 0) {
+    InputEvent e = {};
+    e.type = type;
+    e.delayMs = delayMs;
+    out.push_back(e);
+}
+inline void PushMove(std::vector<InputEvent>& out, POINT pt, int delayMs = 0) {
+    PushEvent(out, EV_MOVE, delayMs);
+    out.back().pt = pt;
+}
+inline void PushButton(std::vector<InputEvent>& out, bool up, ClickButton button, int delayMs = 0) {
+    PushEvent(out, up ? EV_BUTTON_UP : EV_BUTTON_DOWN, delayMs);
+    out.back().button = button;
+}
+
+// Modifier keys go down first and come up last, in reverse order
+const UINT PLAN_MODIFIERS[] = { MOD_CONTROL, MOD_SHIFT, MOD_ALT, MOD_WIN };
+
+// Build the complete event list for an action, in delivery order
+inline void PlanInput(const InputAction& a, std::vector<InputEvent>& out) {
+    if (a.moveFirst && a.kind != ACT_DRAG) PushMove(out, a.at); // Move and act without interleaving
+
+    for (UINT m : PLAN_MODIFIERS)
+        if (a.modifiers & m) { PushEvent(out, EV_KEY_DOWN); out.back().modifier = m; }
+
+    switch (a.kind) {
+    case ACT_CLICK:
+        for (int i = 0; i < a.clicks; ++i) { // Clicks in one batch stay within double-click time
+            PushButton(out, false, a.button);
+            PushButton(out, true, a.button);
+        }
+        break;
+    case ACT_SCROLL: // One wheel event per notch so applications see discrete steps
+        for (int i = 0; i < std::abs(a.notches); ++i) {
+            PushEvent(out, EV_WHEEL);
+            out.back().notches = a.notches > 0 ? 1 : -1;
+            out.back().horizontal = a.horizontal;
+        }
+        break;
+    case ACT_DRAG: // Press at start, move in paced steps so drag thresholds trigger, release at end
+        PushMove(out, a.from);
+        PushButton(out, false, a.button);
+        for (int i = 1; i <= DRAG_STEPS; ++i) {
+            POINT p = { a.from.x + (a.to.x - a.from.x) * i / DRAG_STEPS,
+                        a.from.y + (a.to.y - a.from.y) * i / DRAG_STEPS };
+            PushMove(out, p, i == 1 ? DRAG_PRESS_DELAY_MS : DRAG_STEP_DELAY_MS);
+        }
+        PushButton(out, true, a.button, DRAG_RELEASE_DELAY_MS);
+        break;
+    }
+
+    for (int i = (int)(sizeof(PLAN_MODIFIERS) / sizeof(PLAN_MODIFIERS[0])) - 1; i >= 0; --i)
+        if (a.modifiers & PLAN_MODIFIERS[i]) { PushEvent(out, EV_KEY_UP); out.back().modifier = PLAN_MODIFIERS[i]; }
+}
+
+// Parse a short action command into an InputAction.
+// Grammar: [mod+...]click|right|middle|double  |  scroll N up|down|left|right  |  drag A->B
+// Drag endpoints are returned as labels in fromLbl/toLbl for the caller to resolve.
+inline bool ParseInputAction(const std::wstring& cmd, InputAction& out, std::wstring& fromLbl, std::wstring& toLbl) {
+    out = InputAction();
+    fromLbl.clear();
+    toLbl.clear();
+
+    std::wstring text = cmd; // Normalize arrows and case
+    for (size_t pos; (pos = text.find(L'\u2192')) != std::wstring::npos; ) text.replace(pos, 1, L" ");
+    for (size_t pos; (pos = text.find(L"->")) != std::wstring::npos; ) text.replace(pos, 2, L" ");
+    std::transform(text.begin(), text.end(), text.begin(), ::towlower);
+
+    std::wstringstream ss(text);
+    std::wstring verb;
+    if (!(ss >> verb)) return false;
+
+    if (verb == L"scroll") {
+        int n = 0;
+        std::wstring dir;
+        if (!(ss >> n >> dir) || n <= 0) return false;
+        out.kind = ACT_SCROLL;
+        if (dir == L"up") out.notches = n;
+        else if (dir == L"down") out.notches = -n;
+        else if (dir == L"right") { out.notches = n; out.horizontal = true; }
+        else if (dir == L"left") { out.notches = -n; out.horizontal = true; }
+        else return false;
+        return true;
+    }
+    if (verb == L"drag") {
+        out.kind = ACT_DRAG;
+        return (ss >> fromLbl >> toLbl) ? true : false;
+    }
+
+    // Click, optionally prefixed with modifiers joined by '+'
+    size_t start = 0, plus;
+    while ((plus = verb.find(L'+', start)) != std::wstring::npos) {
+        std::wstring mod = verb.substr(start, plus - start);
+        if (mod == L"ctrl") out.modifiers |= MOD_CONTROL;
+        else if (mod == L"shift") out.modifiers |= MOD_SHIFT;
+        else if (mod == L"alt") out.modifiers |= MOD_ALT;
+        else if (mod == L"win") out.modifiers |= MOD_WIN;
+        else return false;
+        start = plus + 1;
+    }
+    std::wstring button = verb.substr(start);
+    out.kind = ACT_CLICK;
+    if (button == L"click" || button == L"left") out.button = BTN_LEFT;
+    else if (button == L"right") out.button = BTN_RIGHT;
+    else if (button == L"middle") out.button = BTN_MIDDLE;
+    else if (button == L"double") out.clicks = 2;
+    else return false;
+    return true;
+}
@@ -0,0 +1,257 @@
+// Vimerate pixel kernels: screen analysis (luma plane, edge blocks, luma statistics), the
+// magnifier's integer upscalers and label compositing. Plain buffers and SSE2 only, no platform headers, so they are
+// shared by every frontend and tested on their own (Tests/KernelsTest.cpp).
+#pragma once
+
+#include <algorithm>   // std::min / std::max / std::fill
+#include <cstdint>     // Fixed-width integers
+#include <cstdlib>     // std::abs
+#include <cstring>     // memcpy
+#include <emmintrin.h> // SSE2 intrinsics
+
+// Analysis runs at half resolution, in blocks of TARGET_BLOCK x TARGET_BLOCK half-resolution pixels
+const int     TARGET_BLOCK = 8;            // Block size; must be 8, one _mm_sad_epu8 half
+const int     TARGET_SCALE = 2;            // Screen pixels per analyzed pixel, each way
+const uint8_t TARGET_EDGE_THRESHOLD = 40;  // |dx| + |dy| a pixel needs to count as an edge
+const int     MAX_SCALE_ZOOM = 8;          // Largest zoom factor the upscalers accept
+
+// --- Screen analysis ---
+
+// Half-resolution luminance of a BGRA image: every other pixel of every other row, BT.601 weights
+// in 8-bit fixed point. Output is (w / 2) x (h / 2); 16 output pixels per SSE2 iteration. Skipping
+// rows halves memory traffic, which dominates at 4K; UI targets are far larger than 2 pixels.
+inline void HalfLumaBGRA(const uint8_t* bgra, int stride, int w, int h, uint8_t* luma) {
+    const __m128i weights = _mm_setr_epi16(29, 150, 77, 0, 29, 150, 77, 0); // B, G, R, A; sums to 256
+    const __m128i zero = _mm_setzero_si128();
+    auto luma4 = [&](const uint8_t* src) { // Pixels 0, 2, 4, 6 from src -> 4 x int32 luma
+        __m128i a = _mm_loadu_si128((const __m128i*)src), b = _mm_loadu_si128((const __m128i*)(src + 16));
+        __m128i px = _mm_unpacklo_epi64(_mm_shuffle_epi32(a, _MM_SHUFFLE(3, 3, 2, 0)),
+                                        _mm_shuffle_epi32(b, _MM_SHUFFLE(3, 3, 2, 0))); // Even pixels
+        __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(px, zero), weights); // b*29+g*150, r*77 (pixels 0, 1)
+        __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(px, zero), weights); // Same for pixels 2, 3
+        lo = _mm_add_epi32(lo, _mm_srli_epi64(lo, 32)); // Pixel sums land in lanes 0 and 2
+        hi = _mm_add_epi32(hi, _mm_srli_epi64(hi, 32));
+        __m128i sums = _mm_unpacklo_epi64(_mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 3, 2, 0)),
+                                          _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 3, 2, 0)));
+        return _mm_srli_epi32(sums, 8);
+    };
+    int lw = w / TARGET_SCALE, lh = h / TARGET_SCALE;
+    for (int y = 0; y < lh; ++y) {
+        const uint8_t* src = bgra + (size_t)y * TARGET_SCALE * stride;
+        uint8_t* dst = luma + (size_t)y * lw;
+        int x = 0;
+        for (; x + 16 <= lw; x += 16) { // 32 source pixels
+            const uint8_t* p = src + (size_t)x * 8;
+            __m128i a = luma4(p), b = luma4(p + 32), c = luma4(p + 64), d = luma4(p + 96);
+            _mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+        }
+        for (; x < lw; ++x) { // Tail
+            const uint8_t* p = src + (size_t)x * 8;
+            dst[x] = (uint8_t)((p[0] * 29 + p[1] * 150 + p[2] * 77) >> 8);
+        }
+    }
+}
+
+// Count edge pixels per 8x8 block. A pixel's gradient is |dx| + |dy| from central differences,
+// saturated to 8 bits; _mm_sad_epu8 sums each 8-pixel run straight into its block. Blocks 2
+// onwards go through SSE2 in pairs; the first two blocks and any odd last block take a scalar
+// pass, which keeps every vector load inside the row's neighbors. Pixels in the outermost rows
+// and columns are not examined.
+inline void EdgeBlocks(const uint8_t* luma, int w, int h, uint16_t* blocks) {
+    int bw = w / TARGET_BLOCK, bh = h / TARGET_BLOCK;
+    std::fill(blocks, blocks + (size_t)bw * bh, (uint16_t)0);
+    const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi8(1);
+    const __m128i thresh = _mm_set1_epi8((char)TARGET_EDGE_THRESHOLD);
+    int yEnd = std::min(h - 1, bh * TARGET_BLOCK);
+    int xEnd = std::min(w - 1, bw * TARGET_BLOCK); // Last examined column + 1
+    auto scalar = [&](const uint8_t* row, uint16_t* brow, int x0, int x1) { // Same test, one pixel at a time
+        for (int x = std::max(x0, 1); x < x1; ++x) {
+            int dx = std::abs(row[x - 1] - row[x + 1]), dy = std::abs(row[x - w] - row[x + w]);
+            if (std::min(dx + dy, 255) > TARGET_EDGE_THRESHOLD) ++brow[x / TARGET_BLOCK];
+        }
+    };
+    for (int y = 1; y < yEnd; ++y) {
+        const uint8_t* row = luma + (size_t)y * w;
+        uint16_t* brow = blocks + (size_t)(y / TARGET_BLOCK) * bw;
+        scalar(row, brow, 0, std::min(2 * TARGET_BLOCK, xEnd)); // Blocks 0 and 1
+        int x = 2 * TARGET_BLOCK;
+        for (; x + 16 <= xEnd; x += 16) { // Two blocks; reads end at x + 16 < w
+            __m128i l = _mm_loadu_si128((const __m128i*)(row + x - 1));
+            __m128i r = _mm_loadu_si128((const __m128i*)(row + x + 1));
+            __m128i u = _mm_loadu_si128((const __m128i*)(row + x - w));
+            __m128i d = _mm_loadu_si128((const __m128i*)(row + x + w));
+            __m128i dx = _mm_or_si128(_mm_subs_epu8(l, r), _mm_subs_epu8(r, l)); // |l - r|
+            __m128i dy = _mm_or_si128(_mm_subs_epu8(u, d), _mm_subs_epu8(d, u)); // |u - d|
+            __m128i over = _mm_subs_epu8(_mm_adds_epu8(dx, dy), thresh); // Nonzero above the threshold
+            __m128i on = _mm_andnot_si128(_mm_cmpeq_epi8(over, zero), one); // 1 per edge pixel
+            __m128i sums = _mm_sad_epu8(on, zero); // Edge count of each 8-pixel half
+            brow[x / TARGET_BLOCK] += (uint16_t)_mm_cvtsi128_si32(sums);
+            brow[x / TARGET_BLOCK + 1] += (uint16_t)_mm_extract_epi16(sums, 4);
+        }
+        scalar(row, brow, std::max(x, 2 * TARGET_BLOCK), xEnd); // Odd last block, last column excluded
+    }
+}
+
+// Sum and sum of squares of luma[y0..y1) x [x0..x1). _mm_sad_epu8 sums 16 pixels per step;
+// squares go through _mm_madd_epi16 into 32-bit lanes that are widened once per row.
+inline void LumaStats(const uint8_t* luma, int stride, int x0, int y0, int x1, int y1, uint64_t& sum, uint64_t& sumSq) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero; // Two 64-bit sums
+    sum = sumSq = 0;
+    for (int y = y0; y < y1; ++y) {
+        const uint8_t* row = luma + (size_t)y * stride;
+        __m128i sq = zero; // Four 32-bit partial sums of squares (< 2^31 for rows up to 4K pixels)
+        int x = x0;
+        for (; x + 16 <= x1; x += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(row + x));
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+            __m128i lo = _mm_unpacklo_epi8(v, zero), hi = _mm_unpackhi_epi8(v, zero);
+            sq = _mm_add_epi32(sq, _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi)));
+        }
+        alignas(16) uint32_t lanes[4];
+        _mm_store_si128((__m128i*)lanes, sq);
+        sumSq += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        for (; x < x1; ++x) { sum += row[x]; sumSq += (uint64_t)row[x] * row[x]; } // Tail
+    }
+    alignas(16) uint64_t halves[2];
+    _mm_store_si128((__m128i*)halves, acc);
+    sum += halves[0] + halves[1];
+}
+
+// --- Magnifier ---
+
+// Nearest-neighbor upscale of a BGRA image by an integer factor into a dw x dh window: each source
+// pixel becomes a zoom x zoom block. The first row of a block is expanded with SSE2 stores (zoom 2
+// interleaves four source pixels per iteration), the remaining rows are copies of it. Output is opaque.
+inline void ScaleNearestBGRA(const uint8_t* src, int srcStride, int sw, int sh, int zoom, uint8_t* dst, int dstStride, int dw, int dh) {
+    dw = std::min(dw, sw * zoom);
+    dh = std::min(dh, sh * zoom);
+    const __m128i opaque = _mm_set1_epi32((int)0xFF000000);
+    for (int y = 0; y < dh; ++y) {
+        uint32_t* out = (uint32_t*)(dst + (size_t)y * dstStride);
+        if (y % zoom) { // Same source row as the line above
+            memcpy(out, dst + (size_t)(y - 1) * dstStride, (size_t)dw * 4);
+            continue;
+        }
+        const uint32_t* in = (const uint32_t*)(src + (size_t)(y / zoom) * srcStride);
+        int x = 0, sx = 0;
+        if (zoom == 2)
+            for (; x + 8 <= dw; x += 8, sx += 4) { // 4 source pixels -> 8 output pixels
+                __m128i v = _mm_or_si128(_mm_loadu_si128((const __m128i*)(in + sx)), opaque);
+                _mm_storeu_si128((__m128i*)(out + x), _mm_unpacklo_epi32(v, v));
+                _mm_storeu_si128((__m128i*)(out + x + 4), _mm_unpackhi_epi32(v, v));
+            }
+        for (; x < dw; x += zoom, ++sx) { // One block run per source pixel
+            uint32_t px = in[sx] | 0xFF000000u;
+            __m128i v = _mm_set1_epi32((int)px);
+            int n = std::min(zoom, dw - x), k = 0;
+            for (; k + 4 <= n; k += 4) _mm_storeu_si128((__m128i*)(out + x + k), v);
+            for (; k < n; ++k) out[x + k] = px;
+        }
+    }
+}
+
+// Bilinear upscale of a BGRA image by an integer factor into a dw x dh window, sampling at output
+// pixel centers with 8-bit weights and clamping at the edges. Each source row is expanded
+// horizontally once into 16-bit channels (2 output pixels per SSE2 iteration) and cached in
+// 'rowBuf' (2 * dw * 4 entries); every output row is then a vertical blend of two cached rows,
+// 4 pixels per iteration. With an integer zoom the sample offsets repeat every 'zoom' pixels, so
+// they come from a small table. zoom <= MAX_SCALE_ZOOM; output is opaque.
+inline void ScaleBilinearBGRA(const uint8_t* src, int srcStride, int sw, int sh, int zoom, uint8_t* dst, int dstStride, int dw, int dh, uint16_t* rowBuf) {
+    dw = std::min(dw, sw * zoom);
+    dh = std::min(dh, sh * zoom);
+    const __m128i zero = _mm_setzero_si128(), full = _mm_set1_epi16(256);
+    const __m128i opaque = _mm_set1_epi32((int)0xFF000000);
+    int phase[MAX_SCALE_ZOOM]; // Fractional offset of each output pixel within its source pixel
+    for (int r = 0; r < zoom; ++r) phase[r] = (2 * r + 1) * 128 / zoom - 128;
+    auto sample = [&](int q, int r, int n, int& i, int& w) { // Output pixel q * zoom + r: source index and weight
+        int f = std::max(0, q * 256 + phase[r]); // (o + 0.5) / zoom - 0.5 in 8-bit fixed point
+        i = std::min(f >> 8, n - 1);
+        w = (i == n - 1) ? 0 : (f & 255); // Past the last pixel: no neighbor to blend
+    };
+    auto blend = [&](__m128i a, __m128i b, __m128i w) { // (a * (256 - w) + b * w) >> 8; fits 16 bits unsigned
+        return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(a, _mm_sub_epi16(full, w)), _mm_mullo_epi16(b, w)), 8);
+    };
+
+    auto expand = [&](int sy, uint16_t* out) { // Horizontal pass over one source row
+        const uint32_t* in = (const uint32_t*)(src + (size_t)sy * srcStride);
+        auto pair = [&](int s0, int s1) { // Two source pixels as 8 16-bit channels
+            return _mm_unpacklo_epi8(_mm_unpacklo_epi32(_mm_cvtsi32_si128((int)in[s0]), _mm_cvtsi32_si128((int)in[s1])), zero);
+        };
+        int x = 0, q = 0, r = 0; // x = q * zoom + r
+        auto next = [&](int& s, int& w) { sample(q, r, sw, s, w); if (++r == zoom) { r = 0; ++q; } };
+        for (; x + 2 <= dw; x += 2) {
+            int s0, w0, s1, w1;
+            next(s0, w0);
+            next(s1, w1);
+            __m128i w = _mm_setr_epi16((short)w0, (short)w0, (short)w0, (short)w0, (short)w1, (short)w1, (short)w1, (short)w1);
+            __m128i a = pair(s0, s1), b = pair(std::min(s0 + 1, sw - 1), std::min(s1 + 1, sw - 1));
+            _mm_storeu_si128((__m128i*)(out + (size_t)x * 4), blend(a, b, w));
+        }
+        if (x < dw) { // Odd tail
+            int s, w;
+            next(s, w);
+            const uint8_t* a = (const uint8_t*)(in + s);
+            const uint8_t* b = (const uint8_t*)(in + std::min(s + 1, sw - 1));
+            for (int c = 0; c < 4; ++c) out[(size_t)x * 4 + c] = (uint16_t)((a[c] * (256 - w) + b[c] * w) >> 8);
+        }
+    };
+    uint16_t* cache[2] = { rowBuf, rowBuf + (size_t)dw * 4 };
+    int cached[2] = { -1, -1 }; // Source row held by each cache slot
+    auto row = [&](int sy) -> const uint16_t* { // Rows are requested in increasing order: evict the older one
+        if (cached[0] == sy) return cache[0];
+        if (cached[1] == sy) return cache[1];
+        int slot = cached[0] < cached[1] ? 0 : 1;
+        expand(sy, cache[slot]);
+        cached[slot] = sy;
+        return cache[slot];
+    };
+
+    for (int y = 0; y < dh; ++y) { // Vertical pass
+        int sy, wy;
+        sample(y / zoom, y % zoom, sh, sy, wy);
+        const uint16_t* r0 = row(sy);
+        const uint16_t* r1 = row(std::min(sy + 1, sh - 1));
+        uint8_t* out = dst + (size_t)y * dstStride;
+        __m128i vw = _mm_set1_epi16((short)wy);
+        int n = dw * 4, i = 0;
+        for (; i + 16 <= n; i += 16) { // 4 pixels
+            __m128i lo = blend(_mm_loadu_si128((const __m128i*)(r0 + i)), _mm_loadu_si128((const __m128i*)(r1 + i)), vw);
+            __m128i hi = blend(_mm_loadu_si128((const __m128i*)(r0 + i + 8)), _mm_loadu_si128((const __m128i*)(r1 + i + 8)), vw);
+            _mm_storeu_si128((__m128i*)(out + i), _mm_or_si128(_mm_packus_epi16(lo, hi), opaque));
+        }
+        for (; i < n; ++i) out[i] = (i & 3) == 3 ? 255 : (uint8_t)((r0[i] * (256 - wy) + r1[i] * wy) >> 8); // Tail
+    }
+}
+
+// --- Compositing ---
+
+// (a * b) / 255, rounded
+inline int Mul255(int a, int b) { int t = a * b + 128; return (t + (t >> 8)) >> 8; }
+
+// Composite interleaved (box, text) coverage masks of mw x mh pixels at (x, y) of a w x h
+// premultiplied BGRA slice: the box mask tinted with 'box', the text mask with 'text' over it, and
+// the result drawn over what is already there. Colors are straight ARGB (0xAARRGGBB).
+inline void BlitCoverage(uint8_t* scan0, int stride, int w, int h, int x, int y, const uint8_t* tile, int mw, int mh,
+                         uint32_t box, uint32_t text) {
+    int ba = (box >> 24) & 0xFF, br = (box >> 16) & 0xFF, bg = (box >> 8) & 0xFF, bb = box & 0xFF;
+    int ta = (text >> 24) & 0xFF, tr = (text >> 16) & 0xFF, tg = (text >> 8) & 0xFF, tb = text & 0xFF;
+
+    int tx0 = std::max(0, -x), ty0 = std::max(0, -y); // Clip the tile to the slice
+    int tx1 = std::min(mw, w - x), ty1 = std::min(mh, h - y);
+    for (int ty = ty0; ty < ty1; ++ty) {
+        const uint8_t* m = tile + ((size_t)ty * mw + tx0) * 2;
+        uint8_t* d = scan0 + (size_t)(y + ty) * stride + (size_t)(x + tx0) * 4;
+        for (int tx = tx0; tx < tx1; ++tx, m += 2, d += 4) {
+            int ab = Mul255(m[0], ba), at = Mul255(m[1], ta); // Box and text alpha
+            if ((ab | at) == 0) continue;
+            int under = 255 - at; // Box shows through the text's uncovered part
+            int a = at + Mul255(ab, under);
+            int inv = 255 - a; // Existing pixels show through the label's uncovered part
+            d[0] = (uint8_t)(Mul255(tb, at) + Mul255(Mul255(bb, ab), under) + Mul255(d[0], inv));
+            d[1] = (uint8_t)(Mul255(tg, at) + Mul255(Mul255(bg, ab), under) + Mul255(d[1], inv));
+            d[2] = (uint8_t)(Mul255(tr, at) + Mul255(Mul255(br, ab), under) + Mul255(d[2], inv));
+            d[3] = (uint8_t)(a + Mul255(d[3], inv));
+        }
+    }
+}
@@ -0,0 +1,17 @@
+// The few Win32 geometry types and hotkey modifier flags the shared core uses. On Windows they come
+// from <windows.h>; elsewhere they are declared here with the same layout and values, so core code
+// reads the same in every frontend.
+#pragma once
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+typedef long         LONG;
+typedef unsigned int UINT;
+struct POINT { LONG x, y; };
+struct RECT  { LONG left, top, right, bottom; };
+const UINT MOD_ALT = 0x0001;     // Modifier flags, as RegisterHotKey takes them
+const UINT MOD_CONTROL = 0x0002;
+const UINT MOD_SHIFT = 0x0004;
+const UINT MOD_WIN = 0x0008;
+#endif
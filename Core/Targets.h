@@ -0,0 +1,151 @@
+// Vimerate content-aware targets: likely click targets (buttons, icons, links) found in a BGRA
+// image of the screen, and labels moved onto them. Built on the kernels in Core/Kernels.h; no
+// platform headers, so every frontend shares it and it is tested on its own (Tests/TargetsTest.cpp).
+#pragma once
+
+#include "Kernels.h"  // HalfLumaBGRA, EdgeBlocks, TARGET_BLOCK / TARGET_SCALE
+#include "Platform.h" // RECT, LONG
+#include <algorithm>  // std::min / std::max / std::sort / std::upper_bound
+#include <cstddef>    // size_t
+#include <cstdint>    // Fixed-width integers
+#include <vector>     // Analysis buffers and target lists
+
+// Detector tuning, on top of the kernels' TARGET_BLOCK, TARGET_SCALE and TARGET_EDGE_THRESHOLD
+const int TARGET_MIN_EDGES = 6;  // Edge pixels that make a block part of a target
+const int TARGET_MAX_W = 20;     // Wider blobs (text lines, toolbars, panels) are not targets, in blocks
+const int TARGET_MAX_H = 5;      // Taller blobs (images, paragraphs) are not targets, in blocks
+
+// Screen analysis buffers, reused across activations so analysis doesn't allocate after warm-up
+struct ScreenAnalysis {
+    RECT                  area = {}; // Screen area the luma plane covers
+    int                   lw = 0, lh = 0; // Luma plane size (half resolution)
+    std::vector<uint8_t>  luma;   // Half-resolution luminance plane
+    std::vector<uint16_t> blocks; // Edge pixel count per block
+    std::vector<int>      parent; // Union-find forest over blocks (-1 = inactive)
+    std::vector<RECT>     boxes;  // Blob bounding box per root, in blocks
+    std::vector<char>     taken;  // Labels already placed on a target (per cell)
+    std::vector<size_t>   placed; // One row's placed cells, sorted by box position
+};
+
+// Build the analysis luma plane for a BGRA image showing the screen area 'area'
+inline void AnalyzeImage(ScreenAnalysis& s, const uint8_t* bgra, int stride, int w, int h, const RECT& area) {
+    s.area = area;
+    s.lw = w / TARGET_SCALE;
+    s.lh = h / TARGET_SCALE;
+    s.luma.resize((size_t)s.lw * s.lh); // Grows with the largest capture, then reused
+    HalfLumaBGRA(bgra, stride, w, h, s.luma.data());
+}
+
+// Likely click targets in the analyzed plane, as screen rectangles: edge-dense blocks joined into
+// 4-connected blobs, keeping blobs of button, icon or link size
+inline void FindTargets(ScreenAnalysis& s, std::vector<RECT>& out) {
+    out.clear();
+    int bw = s.lw / TARGET_BLOCK, bh = s.lh / TARGET_BLOCK;
+    if (bw < 3 || bh < 3) return; // Too small to hold anything
+    size_t n = (size_t)bw * bh;
+    s.blocks.resize(n);
+    s.parent.resize(n);
+    s.boxes.resize(n);
+    EdgeBlocks(s.luma.data(), s.lw, s.lh, s.blocks.data());
+
+    // Union-find over active blocks; the root of a blob is its lowest index (first in raster order)
+    auto find = [&s](int i) { while (s.parent[i] != i) i = s.parent[i] = s.parent[s.parent[i]]; return i; };
+    auto join = [&](int a, int b) {
+        a = find(a); b = find(b);
+        if (a != b) s.parent[std::max(a, b)] = std::min(a, b);
+    };
+    for (size_t i = 0; i < n; ++i) s.parent[i] = s.blocks[i] >= TARGET_MIN_EDGES ? (int)i : -1;
+    for (int by = 0; by < bh; ++by)
+        for (int bx = 0; bx < bw; ++bx) {
+            int i = by * bw + bx;
+            if (s.parent[i] < 0) continue;
+            if (bx > 0 && s.parent[i - 1] >= 0) join(i, i - 1);
+            if (by > 0 && s.parent[i - bw] >= 0) join(i, i - bw);
+        }
+
+    for (int by = 0; by < bh; ++by) // Bounding box per blob
+        for (int bx = 0; bx < bw; ++bx) {
+            int i = by * bw + bx;
+            if (s.parent[i] < 0) continue;
+            int r = find(i);
+            RECT& b = s.boxes[r];
+            if (r == i) b = { bx, by, bx + 1, by + 1 }; // Root comes first: start its box
+            else {
+                b.left = std::min(b.left, (LONG)bx); b.right = std::max(b.right, (LONG)bx + 1);
+                b.bottom = std::max(b.bottom, (LONG)by + 1); // Rows only grow in raster order
+            }
+        }
+
+    for (size_t i = 0; i < n; ++i) {
+        if (s.parent[i] != (int)i) continue; // Roots only
+        const RECT& b = s.boxes[i];
+        LONG bwBlocks = b.right - b.left, bhBlocks = b.bottom - b.top;
+        if (bwBlocks > TARGET_MAX_W || bhBlocks > TARGET_MAX_H) continue; // Large regions
+        const LONG k = TARGET_BLOCK * TARGET_SCALE; // Blocks to screen pixels
+        out.push_back({ s.area.left + b.left * k, s.area.top + b.top * k,
+                        s.area.left + b.right * k, s.area.top + b.bottom * k });
+    }
+}
+
+// Likely click targets in a BGRA image, in image pixels (fixtures, tests and benchmarks)
+inline void DetectTargets(ScreenAnalysis& s, const uint8_t* bgra, int stride, int w, int h, std::vector<RECT>& out) {
+    AnalyzeImage(s, bgra, stride, w, h, { 0, 0, w, h });
+    FindTargets(s, out);
+}
+
+// Move labels onto targets. 'cells' are laid out on the grid with the given row and column edges,
+// in Core/Grid.h order; each needs an 'rc' (label box) and a 'pt' (jump point). Each target takes
+// the free label in its own grid row whose column is nearest; labels without a target get an empty
+// rc and are hidden. Labels never change rows, so banded rendering still finds every label in its
+// band. Boxes of nearby targets in a row are then pushed apart so they don't overlap; jumps still
+// land on the targets.
+template <class CellT>
+inline void PlaceTargets(const std::vector<RECT>& targets, const RECT& area, int poolSize, const std::vector<LONG>& rowEdges,
+                         const std::vector<LONG>& colEdges, std::vector<CellT>& cells, ScreenAnalysis& s) {
+    int cols = poolSize * 2; // Normal + dotted columns
+    std::vector<char>& taken = s.taken;
+    taken.assign(cells.size(), 0); // Keeps capacity: no allocation per keystroke
+
+    for (const RECT& t : targets) {
+        LONG cx = (t.left + t.right) / 2, cy = (t.top + t.bottom) / 2; // Target center
+        int row = (int)(std::upper_bound(rowEdges.begin() + 1, rowEdges.end() - 1, cy) - rowEdges.begin()) - 1; // Layout's rows
+        int col0 = (int)(std::upper_bound(colEdges.begin() + 1, colEdges.end() - 1, cx) - colEdges.begin()) - 1;
+        for (int d = 0; d < cols * 2; ++d) { // Nearest free column: col0, col0-1, col0+1, col0-2, ...
+            int col = col0 + ((d & 1) ? -(d + 1) / 2 : d / 2);
+            if (col < 0 || col >= cols) continue;
+            size_t idx = ((size_t)row * poolSize + col % poolSize) * 2 + (col >= poolSize); // Core/Grid.h order
+            if (idx >= cells.size() || taken[idx]) continue;
+            taken[idx] = 1;
+            CellT& c = cells[idx];
+            LONG half = (colEdges[col0 + 1] - colEdges[col0]) / 2; // Label box as wide as the cell under the target
+            LONG left = std::max(area.left, std::min(cx - half, area.right - 2 * half)); // Stay inside the grid
+            c.rc = { left, c.rc.top, left + 2 * half, c.rc.bottom }; // Over the target, in its own row
+            c.pt = { cx, cy }; // Jumps land on the target itself
+            break;
+        }
+    }
+    for (size_t i = 0; i < cells.size(); ++i)
+        if (!taken[i]) cells[i].rc = { 0, 0, 0, 0 }; // No target: not shown
+
+    std::vector<size_t>& placed = s.placed; // Keeps capacity, like 'taken'
+    for (size_t row = 0; row * cols < cells.size(); ++row) {
+        placed.clear();
+        for (size_t i = row * cols; i < std::min(cells.size(), (row + 1) * cols); ++i)
+            if (taken[i]) placed.push_back(i);
+        std::sort(placed.begin(), placed.end(), [&cells](size_t a, size_t b) { return cells[a].rc.left < cells[b].rc.left; });
+        LONG edge = area.left; // Sweep right: each box starts after the previous one
+        for (size_t i : placed) {
+            RECT& rc = cells[i].rc;
+            LONG shift = std::max(0L, (LONG)(edge - rc.left));
+            rc.left += shift; rc.right += shift;
+            edge = rc.right;
+        }
+        edge = area.right; // Sweep back: boxes pushed past the grid's edge move left again
+        for (auto it = placed.rbegin(); it != placed.rend(); ++it) {
+            RECT& rc = cells[*it].rc;
+            LONG shift = std::max(0L, (LONG)(rc.right - edge));
+            rc.left -= shift; rc.right -= shift;
+            edge = rc.left;
+        }
+    }
+}
@@ -0,0 +1,90 @@
+// Checks that the keystroke path in Core/Grid.h never touches the heap once warm: GridSession::Key,
+// then FilterByPrefix and LayoutGrid (uniform and foveated), as both frontends run them on every
+// key. A counting global operator new sees every allocation the code under test makes.
+
+#include "../Core/Grid.h"
+#include <cstdio>  // printf
+#include <cstdlib> // malloc / free
+#include <new>     // std::bad_alloc
+
+static long g_allocations = 0; // Heap allocations so far (single-threaded test)
+
+void* operator new(size_t n) {
+    ++g_allocations;
+    if (void* p = malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+static int g_failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { ++g_failures; printf(__VA_ARGS__); printf("\n"); return; } } while (0)
+
+struct TestCell { std::wstring lbl; RECT rc; POINT pt; };
+
+// One frontend's grid: cells, the filtered view and the layout edges, sized once like GenerateCells
+struct Frontend {
+    GridSession            grid;
+    std::vector<TestCell>  cells;
+    std::vector<TestCell*> filtered;
+    std::vector<LONG>      rowEdges, colEdges;
+    RECT                   area = { 0, 0, 3840, 2160 };
+    POINT                  focus = { 1200, 700 };
+    int                    pool;
+
+    explicit Frontend(int poolSize) : pool(poolSize) {
+        cells.resize(GridCellCount(poolSize));
+        wchar_t lbl[4];
+        for (size_t i = 0; i < cells.size(); ++i) {
+            int n = CellLabel(i, poolSize, lbl);
+            cells[i].lbl.assign(lbl, n); // Short labels stay in the string's inline buffer
+        }
+        filtered.reserve(cells.size());
+    }
+
+    // What a frontend does with a key: filter and redraw, or look the label up
+    void Key(GridKey key, wchar_t ch, bool foveated) {
+        GridResult r = grid.Key(key, ch);
+        if (r.step != STEP_FILTER && r.step != STEP_LOOKUP) return;
+        FilterByPrefix(cells, grid.typed, filtered);
+        LayoutGrid(cells, area, pool, foveated ? &focus : nullptr, rowEdges, colEdges);
+    }
+
+    // Type a prefix, then a whole label, and erase it all again
+    void Round(bool foveated) {
+        grid.Show();
+        Key(GKEY_CHAR, L'q', foveated);
+        Key(GKEY_CHAR, L'.', foveated);
+        Key(GKEY_BACKSPACE, 0, foveated);
+        Key(GKEY_CHAR, L'7', foveated);
+        Key(GKEY_BACKSPACE, 0, foveated);
+        Key(GKEY_BACKSPACE, 0, foveated);
+        Key(GKEY_CHAR, L'!', foveated); // Ignored: not in the pool
+    }
+};
+
+static void TestSteadyState(int poolSize, bool foveated) {
+    Frontend f(poolSize);
+    f.Round(foveated); // Warm-up: edges and the filtered view reach their size
+    long before = g_allocations;
+    for (int i = 0; i < 100; ++i) f.Round(foveated);
+    long allocs = g_allocations - before;
+    CHECK(allocs == 0, "pool %d%s: %ld allocation(s) in 100 rounds of typing after warm-up", poolSize,
+          foveated ? " (foveated)" : "", allocs);
+    CHECK(f.filtered.size() == f.cells.size(), "pool %d: erasing everything should show the whole grid", poolSize);
+}
+
+int main() {
+    long before = g_allocations;
+    std::vector<int> probe(3);
+    if (g_allocations == before) { printf("alloc: operator new is not being counted\n"); return 1; }
+    TestSteadyState(36, false);
+    TestSteadyState(36, true);
+    TestSteadyState(MIN_POOL_SIZE, false);
+    if (g_failures) { printf("%d allocation check(s) failed\n", g_failures); return 1; }
+    printf("alloc: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Checks the automation protocol in Core/Commands.h: label resolution, each command's reply and the
+// action it hands the frontend, and batching of the bytes a client sends (partial lines, CRLF,
+// UTF-8), as the Win32 pipe and the X11 socket both serve it.
+
+#include "../Core/Commands.h"
+#include <cstdio>  // printf
+#include <vector>  // Recorded calls
+
+static int g_failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { ++g_failures; printf(__VA_ARGS__); printf("\n"); return; } } while (0)
+
+const RECT AREA = { 0, 0, 1920, 1080 };
+const int  POOL_SIZE = 36;
+
+// What the frontend was asked to do
+static std::vector<POINT>       g_moves;
+static std::vector<InputAction> g_actions;
+static void RecordMove(POINT pt) { g_moves.push_back(pt); }
+static void RecordPerform(const InputAction& action) { g_actions.push_back(action); }
+static const CommandActions RECORD = { RecordMove, RecordPerform };
+
+static std::string Run(const char* line) {
+    g_moves.clear();
+    g_actions.clear();
+    std::string reply;
+    ExecuteCommand(Utf8ToWide(line), POOL_SIZE, AREA, RECORD, reply);
+    return reply;
+}
+
+static POINT Center(const wchar_t* lbl) {
+    RECT rc = {};
+    LabelRect(lbl, POOL_SIZE, AREA, rc);
+    return { (rc.left + rc.right) / 2, (rc.top + rc.bottom) / 2 };
+}
+
+static std::string Coords(POINT pt) { return std::to_string(pt.x) + " " + std::to_string(pt.y); }
+
+static void TestResolve() {
+    POINT ab = Center(L"ab"), zd = Center(L"z.9");
+    CHECK(Run("resolve ab z.9") == "ok " + Coords(ab) + " " + Coords(zd) + "\n", "resolve replied '%s'", Run("resolve ab z.9").c_str());
+    CHECK(g_moves.empty() && g_actions.empty(), "resolve must not move or act");
+    CHECK(Run("resolve ab !!") == "err unknown label\n", "an unknown label must fail the whole resolve");
+    RECT small = { 100, 100, 700, 460 };
+    POINT pt;
+    CHECK(ResolveLabel(L"aa", 6, small, pt) && pt.x == 100 + 600 / 12 / 2 && pt.y == 100 + 360 / 6 / 2,
+          "labels resolve inside the area they are given");
+    CHECK(!ResolveLabel(L"gg", 6, small, pt), "a label outside the pool must not resolve");
+}
+
+static void TestMoveAndAct() {
+    POINT cd = Center(L"cd");
+    CHECK(Run("move cd") == "ok " + Coords(cd) + "\n" && g_moves.size() == 1 && g_moves[0].x == cd.x && g_moves[0].y == cd.y,
+          "move must put the cursor on the label");
+    CHECK(Run("act cd ctrl+double") == "ok " + Coords(cd) + "\n" && g_actions.size() == 1, "act must perform one action");
+    const InputAction& a = g_actions[0];
+    CHECK(a.kind == ACT_CLICK && a.clicks == 2 && a.modifiers == MOD_CONTROL && a.moveFirst && a.at.x == cd.x && a.at.y == cd.y,
+          "act must click at the label, moving in the same batch");
+    CHECK(Run("act cd scroll 3 down") == "ok " + Coords(cd) + "\n" && g_actions.size() == 1 && g_actions[0].kind == ACT_SCROLL &&
+              g_actions[0].notches == -3, "act scroll");
+    CHECK(Run("act cd wiggle") == "err bad action\n" && g_actions.empty(), "an unknown action must fail without acting");
+    CHECK(Run("act cd drag ab cd") == "err bad action\n" && g_actions.empty(), "act must not drag");
+    CHECK(Run("move") == "err unknown label\n" && g_moves.empty(), "move without a label");
+}
+
+static void TestDrag() {
+    POINT ab = Center(L"ab"), cd = Center(L"c.d");
+    CHECK(Run("drag ab->c.d") == "ok\n" && g_actions.size() == 1, "drag must perform one action");
+    const InputAction& a = g_actions[0];
+    CHECK(a.kind == ACT_DRAG && a.from.x == ab.x && a.from.y == ab.y && a.to.x == cd.x && a.to.y == cd.y, "drag endpoints");
+    CHECK(Run("drag ab \xE2\x86\x92 c.d") == "ok\n" && g_actions.size() == 1, "a UTF-8 arrow must work like ->");
+    CHECK(Run("drag ab->!!") == "err bad drag\n" && g_actions.empty(), "a drag to an unknown label must not act");
+}
+
+static void TestOther() {
+    CHECK(Run("launch") == "err unknown command\n", "unknown commands get an error reply");
+    CHECK(Run("   ").empty(), "blank lines get no reply");
+}
+
+// Lines arrive in arbitrary pieces: each complete one is answered in order, the rest waits
+static void TestBatch() {
+    std::string pending = "resolve ab\r\nmove c", reply;
+    ExecuteCommandBatch(pending, POOL_SIZE, AREA, RECORD, reply);
+    CHECK(reply == "ok " + Coords(Center(L"ab")) + "\n" && pending == "move c", "first piece: reply '%s', pending '%s'",
+          reply.c_str(), pending.c_str());
+    pending += "d\n\nbogus\n";
+    reply.clear();
+    ExecuteCommandBatch(pending, POOL_SIZE, AREA, RECORD, reply);
+    CHECK(reply == "ok " + Coords(Center(L"cd")) + "\nerr unknown command\n" && pending.empty(),
+          "second piece: reply '%s'", reply.c_str());
+    CHECK(Utf8ToWide("a\xE2\x86\x92" "b") == L"a\u2192b" && Utf8ToWide("\xFF") == L"\uFFFD" && Utf8ToWide("\xE2\x86") == L"\uFFFD\uFFFD",
+          "UTF-8 decoding");
+}
+
+int main() {
+    TestResolve();
+    TestMoveAndAct();
+    TestDrag();
+    TestOther();
+    TestBatch();
+    if (g_failures) { printf("%d command check(s) failed\n", g_failures); return 1; }
+    printf("commands: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,89 @@
+// Checks the built-in font in Core/Font.h: every label fits its cell at the default setup, measured
+// widths agree with what is drawn, and the text stays readable at 96 DPI.
+
+#include "../Core/Font.h"
+#include <cstdio>  // printf
+#include <string>  // Label text
+#include <vector>  // Coverage masks
+
+static int g_failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { ++g_failures; printf(__VA_ARGS__); printf("\n"); return; } } while (0)
+
+const wchar_t POOL[] = L"abcdefghijklmnopqrstuvwxyz0123456789"; // The full label alphabet (pool size 36)
+
+// Every label the grid can show: two characters, or two around a '.'
+static std::vector<std::wstring> AllLabels() {
+    std::vector<std::wstring> out;
+    for (const wchar_t* a = POOL; *a; ++a)
+        for (const wchar_t* b = POOL; *b; ++b) {
+            out.push_back({ *a, *b });
+            out.push_back({ *a, L'.', *b });
+        }
+    return out;
+}
+
+// Default setup: 1920 x 1080 at 96 DPI, pool 36, so 2 x 36 columns and 36 rows
+static void TestLabelsFitDefaultCells() {
+    int scale = FontScale(96);
+    int cellW = 1920 / (2 * 36), cellH = 1080 / 36;
+    for (const auto& lbl : AllLabels()) {
+        int w = LabelBoxWidth(lbl.c_str(), scale);
+        CHECK(w <= cellW, "label '%ls' is %d pixels wide, the default cell %d", lbl.c_str(), w, cellW);
+    }
+    CHECK(LabelBoxHeight(scale) <= cellH, "labels are %d pixels high, the default cell %d", LabelBoxHeight(scale), cellH);
+}
+
+// TextWidth is exactly the extent RasterizeText covers (text ending in a glyph, not a space)
+static void TestWidthMatchesRaster(const wchar_t* text, int scale, int bold) {
+    int w = TextWidth(text, scale, bold), h = FONT_GLYPH_H * scale;
+    std::vector<uint8_t> mask((size_t)(w + 8) * h, 0);
+    RasterizeText(text, scale, bold, mask.data(), 1, w + 8, w + 8, h, 0, 0);
+    int right = 0, left = w + 8;
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w + 8; ++x)
+            if (mask[(size_t)y * (w + 8) + x]) { right = std::max(right, x + 1); left = std::min(left, x); }
+    CHECK(left == 0 && right == w, "'%ls' at scale %d bold %d: drawn over [%d, %d), measured %d", text, scale, bold, left, right, w);
+}
+
+// Every alphabet character has a glyph, and a label's '.' stays visible at the label scale
+static void TestGlyphs() {
+    for (const wchar_t* p = POOL; *p; ++p) {
+        int g = GlyphIndex(*p);
+        CHECK(g >= 0, "no glyph for '%lc'", *p);
+        uint8_t used = 0;
+        for (int r = 0; r < FONT_GLYPH_H; ++r) used |= FONT_GLYPHS[g][r];
+        CHECK(used, "glyph for '%lc' is blank", *p);
+    }
+    int scale = FontScale(96);
+    CHECK(TextWidth(L"a.b", scale, 0) > TextWidth(L"ab", scale, 0), "dotted labels are no wider than plain ones");
+}
+
+// Font pixels at 96 DPI are 2 screen pixels: 1 is unreadable for labels and the prompt alike
+static void TestScale() {
+    CHECK(FontScale(96) == 2, "scale at 96 DPI is %d", FontScale(96));
+    CHECK(FontScale(144) == 3 && FontScale(192) == 4, "scale at 144/192 DPI is %d/%d", FontScale(144), FontScale(192));
+    CHECK(FontScale(10000) == FONT_MAX_SCALE, "scale is not capped");
+}
+
+static void TestRoundedBox() {
+    const int w = 20, h = 12;
+    uint8_t mask[w * h];
+    RoundedBoxMask(mask, 1, w, w, h, 4.0f);
+    CHECK(mask[0] == 0 && mask[w - 1] == 0, "corners are covered: %d %d", mask[0], mask[w - 1]);
+    CHECK(mask[(h / 2) * w] == 255 && mask[(h / 2) * w + w / 2] == 255, "edges or center are not covered");
+}
+
+int main() {
+    TestLabelsFitDefaultCells();
+    for (int scale = 1; scale <= FONT_MAX_SCALE; ++scale) {
+        TestWidthMatchesRaster(L"mw", scale, LabelStyleFor(scale).bold);
+        TestWidthMatchesRaster(L"m.w", scale, LabelStyleFor(scale).bold);
+        TestWidthMatchesRaster(L"1=Left 2=Right 3=Double d=Drag j/k=Scroll", scale, 0);
+    }
+    TestGlyphs();
+    TestScale();
+    TestRoundedBox();
+    if (g_failures) { printf("%d font check(s) failed\n", g_failures); return 1; }
+    printf("font: all checks passed\n");
+    return 0;
+}
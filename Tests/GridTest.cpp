@@ -0,0 +1,140 @@
+// Checks the grid model and key handling in Core/Grid.h: cell numbering, uniform and foveated
+// geometry, fitting a grid to a small window, prompt placement, and the key sequences each
+// frontend relies on.
+
+#include "../Core/Grid.h"
+#include <cstdio>  // printf
+#include <cwchar>  // wcslen
+
+static int g_failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { ++g_failures; printf(__VA_ARGS__); printf("\n"); return; } } while (0)
+
+// Every cell has a distinct label, and LabelRect finds the cell CellPosition puts it in
+static void TestCells(int poolSize) {
+    const RECT area = { 0, 0, 1920, 1080 };
+    std::vector<LONG> rows, cols;
+    GridEdges(area, poolSize, nullptr, rows, cols);
+    std::vector<std::wstring> seen;
+    wchar_t lbl[4];
+    for (size_t i = 0; i < GridCellCount(poolSize); ++i) {
+        int n = CellLabel(i, poolSize, lbl);
+        CHECK(n == (int)wcslen(lbl) && (n == 2 || (n == 3 && lbl[1] == L'.')), "cell %zu: bad label '%ls'", i, lbl);
+        seen.push_back(lbl);
+        size_t row, col;
+        CellPosition(i, poolSize, row, col);
+        RECT rc;
+        CHECK(LabelRect(lbl, poolSize, area, rc), "pool %d: '%ls' does not resolve", poolSize, lbl);
+        CHECK(rc.left == cols[col] && rc.right == cols[col + 1] && rc.top == rows[row] && rc.bottom == rows[row + 1],
+              "pool %d: '%ls' resolves to %ld,%ld-%ld,%ld, the layout puts it at %ld,%ld-%ld,%ld", poolSize, lbl, (long)rc.left,
+              (long)rc.top, (long)rc.right, (long)rc.bottom, (long)cols[col], (long)rows[row], (long)cols[col + 1], (long)rows[row + 1]);
+    }
+    std::sort(seen.begin(), seen.end());
+    CHECK(std::unique(seen.begin(), seen.end()) == seen.end(), "pool %d: duplicate labels", poolSize);
+    RECT rc;
+    if (poolSize < (int)POOL.length())
+        CHECK(!LabelRect(std::wstring(2, POOL[poolSize]), poolSize, area, rc), "pool %d: a label outside the pool resolves", poolSize);
+}
+
+// Foveated edges cover the axis in order, are finer at the focus than at the far edge, and never
+// go below the minimum cell
+static void TestFoveated() {
+    const RECT area = { 0, 0, 1920, 1080 };
+    const POINT focus = { 400, 300 };
+    std::vector<LONG> rows, cols;
+    GridEdges(area, 20, &focus, rows, cols); // At pool 36 a 1920 pixel row has no room to foveate
+    CHECK(cols.front() == 0 && cols.back() == 1920 && rows.front() == 0 && rows.back() == 1080, "edges don't span the area");
+    for (size_t i = 1; i < cols.size(); ++i)
+        CHECK(cols[i] - cols[i - 1] >= FOVEA_MIN_CELL_W - 1, "column %zu is %ld pixels wide", i - 1, (long)(cols[i] - cols[i - 1]));
+    size_t at = (size_t)(std::upper_bound(cols.begin(), cols.end(), focus.x) - cols.begin()) - 1;
+    CHECK(cols[at + 1] - cols[at] < cols.back() - cols[cols.size() - 2], "the focus column is not finer than the last one");
+}
+
+// A small window lowers the pool until every label box fits its cell; a tiny one fits nothing
+static void TestSmallWindow() {
+    int scale = FontScale(96);
+    const RECT screen = { 0, 0, 1920, 1080 };
+    CHECK(FittingPool(screen, 36, scale) == 36, "the default grid must fit a 1920x1080 screen at 96 DPI");
+    const RECT window = { 300, 200, 900, 560 }; // 600 x 360
+    int pool = FittingPool(window, 36, scale);
+    CHECK(pool >= MIN_POOL_SIZE && pool < 36, "a 600x360 window should lower the pool, got %d", pool);
+    CHECK(!GridFits(window, pool + 1, scale), "pool %d is not the largest that fits", pool);
+    wchar_t lbl[4];
+    for (size_t i = 0; i < GridCellCount(pool); ++i) {
+        CellLabel(i, pool, lbl);
+        RECT rc;
+        CHECK(LabelRect(lbl, pool, window, rc), "pool %d: '%ls' does not resolve", pool, lbl);
+        CHECK(rc.right - rc.left >= LabelBoxWidth(lbl, scale) && rc.bottom - rc.top >= LabelBoxHeight(scale),
+              "pool %d: '%ls' does not fit its %ldx%ld cell", pool, lbl, (long)(rc.right - rc.left), (long)(rc.bottom - rc.top));
+    }
+    CHECK(FittingPool(window, 8, scale) == std::min(pool, 8), "a lower setting is kept when it fits");
+    const RECT tiny = { 0, 0, 200, 100 };
+    CHECK(FittingPool(tiny, 36, scale) == 0, "a 200x100 window cannot hold the smallest grid");
+}
+
+static void TestPrompt() {
+    const RECT area = { 0, 0, 1920, 1080 };
+    int scale = FontScale(96);
+    RECT rc = { 100, 500, 126, 530 }, p = PromptRect(rc, area, scale);
+    CHECK(p.left > rc.right && p.right - p.left == PromptBoxWidth(PROMPT_TEXT, scale), "prompt should sit right of the cell");
+    rc = { 1894, 1060, 1920, 1080 };
+    p = PromptRect(rc, area, scale);
+    CHECK(p.right < rc.left && p.bottom <= area.bottom, "prompt at the corner must move left and stay inside");
+}
+
+// Type a label, then a prompt key
+static void TestTypingAndPrompt() {
+    GridSession g;
+    CHECK(g.Key(GKEY_CHAR, L'a').step == STEP_NONE, "keys while hidden must be ignored");
+    g.Show();
+    CHECK(g.Key(GKEY_CHAR, L'a').step == STEP_FILTER && g.typed == L"a", "first key filters");
+    CHECK(g.Key(GKEY_CHAR, L'!').step == STEP_NONE && g.typed == L"a", "characters outside the pool are ignored");
+    CHECK(g.Key(GKEY_CHAR, L'.').step == STEP_LOOKUP, "'a.' is as long as a label");
+    CHECK(g.Key(GKEY_BACKSPACE, 0).step == STEP_FILTER && g.typed == L"a", "backspace erases one character");
+    CHECK(g.Key(GKEY_CHAR, L'b').step == STEP_LOOKUP && g.typed == L"ab", "'ab' is a label");
+    GridResult r = g.Select({ 10, 20 });
+    CHECK(r.step == STEP_PROMPT && g.state == WAIT_CLICK, "a match opens the prompt");
+    r = g.Key(GKEY_CHAR, L'K');
+    CHECK(r.step == STEP_SCROLL && r.action.kind == ACT_SCROLL && r.action.notches == SCROLL_NOTCHES && g.state == WAIT_CLICK,
+          "k scrolls up and keeps the prompt (by position, so any case)");
+    r = g.Key(GKEY_LEFT, 0);
+    CHECK(r.step == STEP_NUDGE && r.dx == -1 && r.dy == 0, "left arrow nudges left");
+    r = g.Key(GKEY_CHAR, L'3');
+    CHECK(r.step == STEP_ACT && r.action.clicks == 2 && g.state == HIDDEN, "3 double-clicks and closes");
+
+    g.Show();
+    g.Key(GKEY_CHAR, L'a'); g.Key(GKEY_CHAR, L'b'); g.Select({ 0, 0 });
+    CHECK(g.Key(GKEY_CHAR, L'x').step == STEP_HIDE && g.state == HIDDEN, "other prompt keys close without acting");
+    g.Show();
+    CHECK(g.Key(GKEY_BACKSPACE, 0).step == STEP_HIDE && g.state == HIDDEN, "backspace with nothing typed closes");
+    g.Show();
+    CHECK(g.Key(GKEY_ESCAPE, 0).step == STEP_HIDE && g.state == HIDDEN, "escape closes");
+}
+
+// d at the prompt, then a second label: one drag from the first target to the second
+static void TestDrag() {
+    GridSession g;
+    g.Show();
+    g.Key(GKEY_CHAR, L'a'); g.Key(GKEY_CHAR, L'b'); g.Select({ 10, 20 });
+    CHECK(g.Key(GKEY_CHAR, L'd').step == STEP_DRAG_START && g.state == SHOW_ALL && g.typed.empty() && g.dragPending,
+          "d goes back to the full grid with a drag pending");
+    g.dragFrom = { 10, 20 }; // The frontend stores the cursor
+    g.Key(GKEY_CHAR, L'c'); g.Key(GKEY_CHAR, L'.'); g.Key(GKEY_CHAR, L'd');
+    GridResult r = g.Select({ 300, 400 });
+    CHECK(r.step == STEP_ACT && r.action.kind == ACT_DRAG && r.action.from.x == 10 && r.action.to.y == 400 && g.state == HIDDEN &&
+              !g.dragPending, "the second label drops the drag and closes");
+    g.Show();
+    CHECK(!g.dragPending, "showing the grid forgets an abandoned drag");
+}
+
+int main() {
+    TestCells(36);
+    TestCells(MIN_POOL_SIZE);
+    TestFoveated();
+    TestSmallWindow();
+    TestPrompt();
+    TestTypingAndPrompt();
+    TestDrag();
+    if (g_failures) { printf("%d grid check(s) failed\n", g_failures); return 1; }
+    printf("grid: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,75 @@
+// Checks the triple-buffer handoff in Core/Handoff.h: the take/publish rules on one thread, then a
+// producer and a consumer thread racing through many values. The consumer must only ever see whole
+// values, in increasing order, and must end on the last one published.
+
+#include "../Core/Handoff.h"
+#include <cstdio>  // printf
+#include <thread>  // Producer and consumer
+#include <vector>  // Payloads
+
+static int g_failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { ++g_failures; printf(__VA_ARGS__); printf("\n"); return; } } while (0)
+
+// A value that tears visibly: every payload entry and the payload length are derived from seq
+struct Message {
+    long              seq = 0;
+    std::vector<long> payload;
+};
+
+static void Fill(Message& m, long seq) {
+    m.seq = seq;
+    m.payload.assign((size_t)(seq % 7 + 1), seq); // Reuses the slot's capacity
+}
+
+static bool Whole(const Message& m) {
+    if (m.payload.size() != (size_t)(m.seq % 7 + 1)) return false;
+    for (long v : m.payload)
+        if (v != m.seq) return false;
+    return true;
+}
+
+// Nothing to take before a publish; only the newest of several publishes is taken, once
+static void TestSingleThread() {
+    Handoff<Message> h;
+    CHECK(!h.Take(), "took a value before anything was published");
+    Fill(*h.producer, 1);
+    h.Publish();
+    Fill(*h.producer, 2);
+    h.Publish();
+    CHECK(h.Take() && h.consumer->seq == 2 && Whole(*h.consumer), "did not take the newest value");
+    CHECK(!h.Take(), "took the same value twice");
+    CHECK(h.producer != h.consumer, "producer and consumer share a slot");
+    Fill(*h.producer, 3);
+    h.Publish();
+    CHECK(h.producer != h.consumer, "publishing handed the producer the consumer's slot");
+    CHECK(h.Take() && h.consumer->seq == 3, "missed a value published after a take");
+}
+
+// Publish 'count' values as fast as possible against a consumer thread
+static void TestStress(long count) {
+    Handoff<Message> h;
+    long errors = 0, last = 0;
+    std::thread consumer([&] {
+        while (last < count) {
+            if (!h.Take()) { std::this_thread::yield(); continue; }
+            const Message& m = *h.consumer;
+            if (m.seq <= last || !Whole(m)) ++errors;
+            last = m.seq;
+        }
+    });
+    for (long i = 1; i <= count; ++i) {
+        Fill(*h.producer, i);
+        h.Publish();
+    }
+    consumer.join(); // Only returns once the last value arrived
+    CHECK(errors == 0, "%ld torn or out-of-order values in %ld", errors, count);
+    CHECK(last == count, "ended on %ld, not %ld", last, count);
+}
+
+int main() {
+    TestSingleThread();
+    TestStress(200000);
+    if (g_failures) { printf("%d handoff check(s) failed\n", g_failures); return 1; }
+    printf("handoff: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,96 @@
+// Checks the input planner in Core/InputPlan.h: event order for clicks, scrolls and drags, held
+// modifiers around the action, drag pacing, and the action command grammar.
+
+#include "../Core/InputPlan.h"
+#include <cstdio>  // printf
+
+static int g_failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { ++g_failures; printf(__VA_ARGS__); printf("\n"); return; } } while (0)
+
+static std::vector<InputEvent> Plan(const InputAction& a) {
+    std::vector<InputEvent> out;
+    PlanInput(a, out);
+    return out;
+}
+static int TotalDelay(const std::vector<InputEvent>& plan) {
+    int ms = 0;
+    for (const auto& e : plan) ms += e.delayMs;
+    return ms;
+}
+
+static void TestClicks() {
+    InputAction a;
+    a.button = BTN_RIGHT;
+    auto p = Plan(a);
+    CHECK(p.size() == 2 && p[0].type == EV_BUTTON_DOWN && p[1].type == EV_BUTTON_UP && p[0].button == BTN_RIGHT,
+          "right click: %zu events", p.size());
+    a.button = BTN_LEFT;
+    a.clicks = 2;
+    a.moveFirst = true;
+    a.at = { 300, 200 };
+    p = Plan(a);
+    CHECK(p.size() == 5 && p[0].type == EV_MOVE && p[0].pt.x == 300 && p[0].pt.y == 200, "double click with move: %zu events",
+          p.size());
+    CHECK(TotalDelay(p) == 0, "clicks must go out as one batch, not paced (%d ms)", TotalDelay(p));
+}
+
+static void TestModifiers() {
+    InputAction a;
+    a.modifiers = MOD_CONTROL | MOD_SHIFT;
+    auto p = Plan(a);
+    CHECK(p.size() == 6, "ctrl+shift+click: %zu events", p.size());
+    CHECK(p[0].type == EV_KEY_DOWN && p[0].modifier == MOD_CONTROL && p[1].type == EV_KEY_DOWN && p[1].modifier == MOD_SHIFT,
+          "modifiers must go down first, control before shift");
+    CHECK(p[4].type == EV_KEY_UP && p[4].modifier == MOD_SHIFT && p[5].type == EV_KEY_UP && p[5].modifier == MOD_CONTROL,
+          "modifiers must come up last, in reverse order");
+}
+
+static void TestScroll() {
+    InputAction a;
+    a.kind = ACT_SCROLL;
+    a.notches = -3;
+    a.horizontal = true;
+    auto p = Plan(a);
+    CHECK(p.size() == 3, "3 notches: %zu events", p.size());
+    for (const auto& e : p) CHECK(e.type == EV_WHEEL && e.notches == -1 && e.horizontal, "one horizontal wheel step per notch");
+}
+
+// Press, paced moves ending on the drop point, a pause, then the release
+static void TestDrag() {
+    InputAction a;
+    a.kind = ACT_DRAG;
+    a.from = { 100, 100 };
+    a.to = { 180, 60 };
+    auto p = Plan(a);
+    CHECK(p.size() == (size_t)DRAG_STEPS + 3, "drag: %zu events", p.size());
+    CHECK(p[0].type == EV_MOVE && p[0].pt.x == 100 && p[0].pt.y == 100 && p[1].type == EV_BUTTON_DOWN,
+          "drag must start with a move to the start point and a press");
+    CHECK(p[2].delayMs >= DRAG_PRESS_DELAY_MS, "no pause between the press and the first move");
+    for (int i = 2; i < 2 + DRAG_STEPS; ++i) CHECK(p[i].type == EV_MOVE && p[i].delayMs > 0, "drag move %d is not paced", i - 1);
+    const InputEvent& last = p[1 + DRAG_STEPS];
+    CHECK(last.pt.x == 180 && last.pt.y == 60, "last move ends at %ld,%ld", (long)last.pt.x, (long)last.pt.y);
+    CHECK(p.back().type == EV_BUTTON_UP && p.back().delayMs >= DRAG_RELEASE_DELAY_MS, "release must come after a pause");
+}
+
+static void TestParse() {
+    InputAction a;
+    std::wstring from, to;
+    CHECK(ParseInputAction(L"ctrl+shift+right", a, from, to) && a.kind == ACT_CLICK && a.button == BTN_RIGHT &&
+              a.modifiers == (MOD_CONTROL | MOD_SHIFT), "ctrl+shift+right");
+    CHECK(ParseInputAction(L"scroll 4 left", a, from, to) && a.kind == ACT_SCROLL && a.notches == -4 && a.horizontal, "scroll 4 left");
+    CHECK(ParseInputAction(L"drag ab->c.d", a, from, to) && a.kind == ACT_DRAG && from == L"ab" && to == L"c.d", "drag ab->c.d");
+    CHECK(ParseInputAction(L"Double", a, from, to) && a.clicks == 2, "double (any case)");
+    CHECK(!ParseInputAction(L"hyper+click", a, from, to) && !ParseInputAction(L"scroll 0 up", a, from, to) &&
+              !ParseInputAction(L"", a, from, to), "bad commands must be rejected");
+}
+
+int main() {
+    TestClicks();
+    TestModifiers();
+    TestScroll();
+    TestDrag();
+    TestParse();
+    if (g_failures) { printf("%d input plan check(s) failed\n", g_failures); return 1; }
+    printf("input plan: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,175 @@
+// Checks the pixel kernels in Core/Kernels.h against straightforward scalar versions, on
+// odd sizes so every vector loop also runs its tail. Each kernel stops at its first mismatch;
+// the exit code is 1 if any check failed.
+
+#include "../Core/Kernels.h"
+#include <cstdio>  // printf
+#include <vector>  // Test images
+
+static int g_failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { ++g_failures; printf(__VA_ARGS__); printf("\n"); return; } } while (0)
+
+// Deterministic pseudo-random bytes (xorshift), so failures reproduce
+static uint32_t g_seed = 2463534242u;
+static uint8_t Rand8() { g_seed ^= g_seed << 13; g_seed ^= g_seed >> 17; g_seed ^= g_seed << 5; return (uint8_t)g_seed; }
+static std::vector<uint8_t> RandomImage(size_t bytes) {
+    std::vector<uint8_t> v(bytes);
+    for (auto& b : v) b = Rand8();
+    return v;
+}
+
+static void TestHalfLuma(int w, int h) {
+    int stride = w * 4 + 12; // Padded rows
+    std::vector<uint8_t> img = RandomImage((size_t)stride * h), luma((size_t)(w / 2) * (h / 2));
+    HalfLumaBGRA(img.data(), stride, w, h, luma.data());
+    for (int y = 0; y < h / 2; ++y)
+        for (int x = 0; x < w / 2; ++x) {
+            const uint8_t* p = &img[(size_t)y * 2 * stride + (size_t)x * 8];
+            int want = (p[0] * 29 + p[1] * 150 + p[2] * 77) >> 8;
+            CHECK(luma[(size_t)y * (w / 2) + x] == want, "HalfLumaBGRA %dx%d: pixel %d,%d is %d, want %d", w, h, x, y,
+                  luma[(size_t)y * (w / 2) + x], want);
+        }
+}
+
+// Reference edge count: every pixel off the outer rows and columns of the whole-block area
+static void TestEdgeBlocks(const std::vector<uint8_t>& luma, int w, int h) {
+    int bw = w / TARGET_BLOCK, bh = h / TARGET_BLOCK;
+    std::vector<uint16_t> blocks((size_t)bw * bh), want((size_t)bw * bh, 0);
+    EdgeBlocks(luma.data(), w, h, blocks.data());
+    for (int y = 1; y < std::min(h - 1, bh * TARGET_BLOCK); ++y)
+        for (int x = 1; x < std::min(w - 1, bw * TARGET_BLOCK); ++x) {
+            const uint8_t* p = &luma[(size_t)y * w + x];
+            int g = std::min(255, std::abs(p[-1] - p[1]) + std::abs(p[-w] - p[w]));
+            if (g > TARGET_EDGE_THRESHOLD) ++want[(size_t)(y / TARGET_BLOCK) * bw + x / TARGET_BLOCK];
+        }
+    for (int i = 0; i < bw * bh; ++i)
+        CHECK(blocks[i] == want[i], "EdgeBlocks %dx%d: block %d,%d counts %d, want %d", w, h, i % bw, i / bw, blocks[i], want[i]);
+}
+
+// Vertical stripes: every examined pixel is an edge, so the first, inner and last blocks of a row
+// all count (uniform counts are what an odd number of blocks used to break)
+static void TestEdgeBlocksStripes(int w, int h) {
+    std::vector<uint8_t> luma((size_t)w * h);
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x) luma[(size_t)y * w + x] = (x / 2) % 2 ? 255 : 0;
+    TestEdgeBlocks(luma, w, h);
+    int bw = w / TARGET_BLOCK;
+    std::vector<uint16_t> blocks((size_t)bw * (h / TARGET_BLOCK));
+    EdgeBlocks(luma.data(), w, h, blocks.data());
+    CHECK(blocks[0] > 0 && blocks[1] > 0 && blocks[bw - 1] > 0, "EdgeBlocks stripes %dx%d: border blocks %d %d %d are empty", w,
+          h, blocks[0], blocks[1], blocks[bw - 1]);
+}
+
+static void TestLumaStats(int w, int h) {
+    std::vector<uint8_t> luma = RandomImage((size_t)w * h);
+    const int rects[][4] = { { 0, 0, w, h }, { 1, 2, w - 3, h - 1 }, { 5, 5, 6, 6 }, { 3, 1, 20, 4 } };
+    for (const auto& r : rects) {
+        uint64_t sum, sumSq, wantSum = 0, wantSq = 0;
+        LumaStats(luma.data(), w, r[0], r[1], r[2], r[3], sum, sumSq);
+        for (int y = r[1]; y < r[3]; ++y)
+            for (int x = r[0]; x < r[2]; ++x) {
+                uint8_t v = luma[(size_t)y * w + x];
+                wantSum += v; wantSq += (uint64_t)v * v;
+            }
+        CHECK(sum == wantSum && sumSq == wantSq, "LumaStats %dx%d rect %d,%d-%d,%d: %llu/%llu, want %llu/%llu", w, h, r[0], r[1],
+              r[2], r[3], (unsigned long long)sum, (unsigned long long)sumSq, (unsigned long long)wantSum, (unsigned long long)wantSq);
+    }
+}
+
+// The upscalers write a dw x dh window (clipped to the scaled image) and must not touch the rest
+static void TestScaleNearest(int sw, int sh, int zoom, int dw, int dh) {
+    std::vector<uint8_t> src = RandomImage((size_t)sw * sh * 4);
+    int stride = dw * 4 + 8;
+    std::vector<uint8_t> dst((size_t)stride * (dh + 1), 0xCD);
+    ScaleNearestBGRA(src.data(), sw * 4, sw, sh, zoom, dst.data(), stride, dw, dh);
+    for (int y = 0; y <= dh; ++y)
+        for (int x = 0; x < stride / 4; ++x) {
+            const uint8_t* got = &dst[(size_t)y * stride + (size_t)x * 4];
+            bool inside = x < dw && x < sw * zoom && y < dh && y < sh * zoom;
+            for (int c = 0; c < 4; ++c) {
+                int want = !inside ? 0xCD : c == 3 ? 255 : src[((size_t)(y / zoom) * sw + x / zoom) * 4 + c];
+                CHECK(got[c] == want, "ScaleNearestBGRA %dx%d x%d: pixel %d,%d channel %d is %d, want %d", sw, sh, zoom, x, y, c,
+                      got[c], want);
+            }
+        }
+}
+
+// Scalar bilinear with the kernel's sampling: output pixel centers, 8-bit weights, a horizontal
+// pass truncated to integers, then a vertical pass
+static void TestScaleBilinear(int sw, int sh, int zoom, int dw, int dh) {
+    std::vector<uint8_t> src = RandomImage((size_t)sw * sh * 4);
+    int stride = dw * 4 + 8;
+    std::vector<uint8_t> dst((size_t)stride * (dh + 1), 0xCD);
+    std::vector<uint16_t> rows((size_t)2 * dw * 4);
+    ScaleBilinearBGRA(src.data(), sw * 4, sw, sh, zoom, dst.data(), stride, dw, dh, rows.data());
+    auto sample = [zoom](int o, int n, int& i, int& w) {
+        int f = std::max(0, (o / zoom) * 256 + (2 * (o % zoom) + 1) * 128 / zoom - 128);
+        i = std::min(f >> 8, n - 1);
+        w = i == n - 1 ? 0 : (f & 255);
+    };
+    auto horizontal = [&](int sy, int x, int c) {
+        int sx, wx;
+        sample(x, sw, sx, wx);
+        int a = src[((size_t)sy * sw + sx) * 4 + c], b = src[((size_t)sy * sw + std::min(sx + 1, sw - 1)) * 4 + c];
+        return (a * (256 - wx) + b * wx) >> 8;
+    };
+    for (int y = 0; y <= dh; ++y)
+        for (int x = 0; x < stride / 4; ++x) {
+            const uint8_t* got = &dst[(size_t)y * stride + (size_t)x * 4];
+            bool inside = x < dw && x < sw * zoom && y < dh && y < sh * zoom;
+            for (int c = 0; c < 4; ++c) {
+                int want = 0xCD;
+                if (inside && c == 3) want = 255;
+                else if (inside) {
+                    int sy, wy;
+                    sample(y, sh, sy, wy);
+                    want = (horizontal(sy, x, c) * (256 - wy) + horizontal(std::min(sy + 1, sh - 1), x, c) * wy) >> 8;
+                }
+                CHECK(got[c] == want, "ScaleBilinearBGRA %dx%d x%d: pixel %d,%d channel %d is %d, want %d", sw, sh, zoom, x, y, c,
+                      got[c], want);
+            }
+        }
+}
+
+// Opaque box under opaque text: each pixel takes the color of the topmost covered layer; uncovered
+// pixels and everything outside the clipped tile keep what was there
+static void TestBlitCoverage() {
+    const int w = 9, h = 5, mw = 4, mh = 3;
+    uint8_t tile[mw * mh * 2] = {};
+    for (int i = 0; i < mw * mh; ++i) { tile[i * 2] = i % 3 ? 255 : 0; tile[i * 2 + 1] = i % 4 == 1 ? 255 : 0; }
+    std::vector<uint8_t> dst((size_t)w * h * 4, 0x40);
+    BlitCoverage(dst.data(), w * 4, w, h, 7, 3, tile, mw, mh, 0xFF102030u, 0xFFA0B0C0u); // Clipped on the right and bottom
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x) {
+            const uint8_t* d = &dst[((size_t)y * w + x) * 4];
+            int tx = x - 7, ty = y - 3, i = ty * mw + tx;
+            bool inside = tx >= 0 && ty >= 0 && tx < mw && ty < mh;
+            uint32_t want = 0x40404040u;
+            if (inside && tile[i * 2 + 1]) want = 0xFFA0B0C0u;
+            else if (inside && tile[i * 2]) want = 0xFF102030u;
+            uint32_t got = (uint32_t)d[3] << 24 | d[2] << 16 | d[1] << 8 | d[0];
+            CHECK(got == want, "BlitCoverage: pixel %d,%d is %08x, want %08x", x, y, got, want);
+        }
+}
+
+int main() {
+    TestHalfLuma(71, 37);
+    TestHalfLuma(256, 64);
+    TestEdgeBlocks(RandomImage(57 * 40), 57, 40); // Odd block count, spare column
+    TestEdgeBlocks(RandomImage(56 * 41), 56, 41); // Odd block count, no spare column
+    TestEdgeBlocks(RandomImage(64 * 24), 64, 24); // Even block count
+    TestEdgeBlocks(RandomImage(16 * 16), 16, 16); // Only the scalar blocks
+    TestEdgeBlocksStripes(56, 32);
+    TestLumaStats(67, 23);
+    TestLumaStats(128, 16);
+    for (int zoom = 2; zoom <= MAX_SCALE_ZOOM; ++zoom) {
+        TestScaleNearest(23, 19, zoom, 61, 45);           // Window inside the scaled image
+        TestScaleNearest(7, 5, zoom, 61, 45);             // Window larger than it
+        TestScaleBilinear(23, 19, zoom, 61, 45);
+        TestScaleBilinear(7, 5, zoom, 61, 45);
+    }
+    TestBlitCoverage();
+    if (g_failures) { printf("%d kernel check(s) failed\n", g_failures); return 1; }
+    printf("kernels: all checks passed\n");
+    return 0;
+}
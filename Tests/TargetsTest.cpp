@@ -0,0 +1,133 @@
+// Checks target detection and label placement in Core/Targets.h on synthetic BGRA screens: buttons
+// are found where they were drawn, panels and blank areas are not, and labels land on the targets
+// without overlapping.
+
+#include "../Core/Grid.h"
+#include "../Core/Targets.h"
+#include <cstdio>  // printf
+#include <vector>  // Images and cells
+
+static int g_failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { ++g_failures; printf(__VA_ARGS__); printf("\n"); return; } } while (0)
+
+// Light gray screen, w x h BGRA
+static std::vector<uint8_t> Blank(int w, int h) { return std::vector<uint8_t>((size_t)w * h * 4, 0xF0); }
+
+static void Fill(std::vector<uint8_t>& px, int w, int x0, int y0, int x1, int y1, uint8_t v) {
+    for (int y = y0; y < y1; ++y)
+        for (int x = x0; x < x1; ++x) {
+            uint8_t* p = &px[((size_t)y * w + x) * 4];
+            p[0] = p[1] = p[2] = v;
+        }
+}
+
+// A 100 x 28 push button: dark border, light face, a caption of six strokes
+static RECT Button(std::vector<uint8_t>& px, int w, int x, int y) {
+    Fill(px, w, x, y, x + 100, y + 28, 0x60);
+    Fill(px, w, x + 1, y + 1, x + 99, y + 27, 0xE0);
+    for (int k = 0; k < 6; ++k) Fill(px, w, x + 14 + k * 12, y + 9, x + 20 + k * 12, y + 19, 0x20);
+    return { x, y, x + 100, y + 28 };
+}
+
+static bool Overlaps(const RECT& a, const RECT& b) {
+    return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+
+// Each drawn button gives exactly one target, within a block of the button's own edges
+static void TestButtons() {
+    const int w = 800, h = 600, k = TARGET_BLOCK * TARGET_SCALE; // k: a block in screen pixels
+    std::vector<uint8_t> px = Blank(w, h);
+    std::vector<RECT> buttons = { Button(px, w, 40, 40), Button(px, w, 400, 40), Button(px, w, 200, 300), Button(px, w, 600, 500) };
+    ScreenAnalysis s;
+    std::vector<RECT> found;
+    DetectTargets(s, px.data(), w * 4, w, h, found);
+    CHECK(found.size() == buttons.size(), "found %zu targets for %zu buttons", found.size(), buttons.size());
+    for (const RECT& b : buttons) {
+        int hits = 0;
+        for (const RECT& t : found) {
+            if (!Overlaps(t, b)) continue;
+            ++hits;
+            CHECK(t.left % k == 0 && t.top % k == 0 && t.right % k == 0 && t.bottom % k == 0, "target is not block aligned");
+            CHECK(t.left >= b.left - k && t.right <= b.right + k && t.top >= b.top - k && t.bottom <= b.bottom + k,
+                  "button %ld,%ld-%ld,%ld detected as %ld,%ld-%ld,%ld", (long)b.left, (long)b.top, (long)b.right, (long)b.bottom,
+                  (long)t.left, (long)t.top, (long)t.right, (long)t.bottom);
+        }
+        CHECK(hits == 1, "button at %ld,%ld gave %d targets", (long)b.left, (long)b.top, hits);
+    }
+}
+
+// Flat screens have no targets; a busy panel wider than TARGET_MAX_W blocks is not one either
+static void TestRejects() {
+    const int w = 800, h = 600;
+    std::vector<uint8_t> px = Blank(w, h);
+    ScreenAnalysis s;
+    std::vector<RECT> found;
+    DetectTargets(s, px.data(), w * 4, w, h, found);
+    CHECK(found.empty(), "a blank screen gave %zu targets", found.size());
+
+    for (int x = 0; x < w; x += 8) Fill(px, w, x, 200, x + 4, 260, 0x20); // Toolbar-like stripes across the screen
+    DetectTargets(s, px.data(), w * 4, w, h, found);
+    CHECK(found.empty(), "a full-width panel gave %zu targets", found.size());
+
+    DetectTargets(s, px.data(), w * 4, 40, 40, found); // Smaller than three blocks each way
+    CHECK(found.empty(), "a 40x40 image gave %zu targets", found.size());
+}
+
+// The screen area offsets targets: an analysis of a window reports screen coordinates
+static void TestArea() {
+    const int w = 400, h = 300;
+    std::vector<uint8_t> px = Blank(w, h);
+    Button(px, w, 96, 96);
+    ScreenAnalysis s;
+    std::vector<RECT> found;
+    AnalyzeImage(s, px.data(), w * 4, w, h, { 1000, 500, 1000 + w, 500 + h });
+    FindTargets(s, found);
+    CHECK(found.size() == 1 && found[0].left >= 1000 + 96 - 16 && found[0].top >= 500 + 96 - 16 && found[0].right <= 1000 + 196 + 16,
+          "a button in a window at 1000,500 was not reported in screen coordinates");
+}
+
+struct TestCell { RECT rc; POINT pt; };
+
+// Labels move onto targets in their own row, the rest are hidden, and boxes in a row never overlap
+static void TestPlacement() {
+    const RECT area = { 0, 0, 1920, 1080 };
+    const int pool = 36;
+    std::vector<LONG> rows, cols;
+    GridEdges(area, pool, nullptr, rows, cols);
+    std::vector<TestCell> cells(GridCellCount(pool));
+    for (size_t i = 0; i < cells.size(); ++i) {
+        size_t row, col;
+        CellPosition(i, pool, row, col);
+        cells[i].rc = { cols[col], rows[row], cols[col + 1], rows[row + 1] };
+    }
+    std::vector<RECT> targets = { { 100, 100, 140, 120 }, { 110, 100, 150, 120 }, { 120, 100, 160, 120 }, { 1900, 1060, 1916, 1076 } };
+    ScreenAnalysis s;
+    PlaceTargets(targets, area, pool, rows, cols, cells, s);
+
+    size_t shown = 0;
+    for (size_t i = 0; i < cells.size(); ++i) {
+        const TestCell& c = cells[i];
+        if (c.rc.right <= c.rc.left) continue;
+        ++shown;
+        size_t row, col;
+        CellPosition(i, pool, row, col);
+        CHECK(c.rc.top == rows[row] && c.rc.bottom == rows[row + 1], "a placed label left its row");
+        CHECK(c.rc.left >= area.left && c.rc.right <= area.right, "a placed label left the grid");
+        bool onTarget = false;
+        for (const RECT& t : targets) onTarget = onTarget || (c.pt.x == (t.left + t.right) / 2 && c.pt.y == (t.top + t.bottom) / 2);
+        CHECK(onTarget, "a placed label does not jump to a target");
+        for (size_t j = i + 1; j < cells.size(); ++j)
+            CHECK(!(cells[j].rc.right > cells[j].rc.left && Overlaps(c.rc, cells[j].rc)), "placed labels overlap");
+    }
+    CHECK(shown == targets.size(), "%zu labels shown for %zu targets", shown, targets.size());
+}
+
+int main() {
+    TestButtons();
+    TestRejects();
+    TestArea();
+    TestPlacement();
+    if (g_failures) { printf("%d target check(s) failed\n", g_failures); return 1; }
+    printf("targets: all checks passed\n");
+    return 0;
+}
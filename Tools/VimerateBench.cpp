@@ -0,0 +1,220 @@
+// VimerateBench: portable benchmark of the shared core (Core/), the parts every frontend runs on
+// every activation and keystroke: the pixel kernels and target detection, grid generation,
+// filtering and layout, and label rasterization and compositing. Writes the same JSON report as
+// the Win32 app's --bench and compares it against a baseline the same way (Core/Bench.h).
+//
+//   cmake --build build --target vimerate-bench
+//   ./vimerate-bench results.json
+//   ./vimerate-bench new.json --baseline results.json --threshold 10 [--min-delta US] [--iterations N]
+//
+// Exit code: 0 on success, 1 if any scenario regressed against the baseline, 2 on bad arguments
+// or unreadable / unwritable files.
+
+#include "../Core/Bench.h"   // Timing, report and baseline comparison
+#include "../Core/Font.h"    // Label and prompt rasterization
+#include "../Core/Grid.h"    // Labels, filtering and layout
+#include "../Core/Kernels.h" // Pixel kernels
+#include "../Core/Targets.h" // Target detection
+#include <cstdio>            // FILE streams
+#include <cstring>           // strcmp / memset
+
+// Pools past POOL's 36 characters: how the grid would scale with a larger alphabet (upper case
+// letters have glyphs too). Up to 36 it is POOL itself, so labels match CellLabel.
+const std::wstring BENCH_ALPHABET = POOL + L"ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+const int BENCH_POOLS[] = { 6, 12, 18, 24, 30, 36, 48, 62 }; // 36 is the full pool today
+const struct { const char* name; int w, h; } BENCH_SCREENS[] = {
+    { "1080p", 1920, 1080 }, { "1440p", 2560, 1440 }, { "4k", 3840, 2160 },
+    { "8k", 7680, 4320 }, { "3x1080p", 5760, 1080 } // Last one: multi-monitor virtual desktop
+};
+const int BENCH_SCALE = 2; // Font scale at 96 DPI
+const uint32_t BENCH_BOX = 0xE0FFF3A0, BENCH_TEXT = 0xFF000000; // Label colors (straight ARGB)
+
+struct BenchCell { std::wstring lbl; RECT rc; POINT pt; };
+
+static volatile uint64_t g_sink; // Results of pure scenarios land here, so they can't be optimized out
+
+// Label of cell i: CellLabel up to POOL's size, the same scheme over BENCH_ALPHABET past it
+static int BenchLabel(size_t i, int pool, wchar_t* out) {
+    if (pool <= (int)POOL.size()) return CellLabel(i, pool, out);
+    out[0] = BENCH_ALPHABET[i / 2 / pool];
+    wchar_t second = BENCH_ALPHABET[i / 2 % pool];
+    if (i & 1) { out[1] = L'.'; out[2] = second; out[3] = L'\0'; return 3; }
+    out[1] = second; out[2] = L'\0';
+    return 2;
+}
+
+// One pool's cells, as a frontend generates them on activation
+static void GenerateBenchCells(std::vector<BenchCell>& cells, int pool) {
+    cells.resize(GridCellCount(pool));
+    wchar_t lbl[4];
+    for (size_t i = 0; i < cells.size(); ++i) cells[i].lbl.assign(lbl, BenchLabel(i, pool, lbl));
+}
+
+// Every label's coverage tile, like the label atlas: (box, text) pairs, label i's tile
+// at slot i and widths[i] wide
+struct LabelTiles {
+    std::vector<uint8_t> masks;
+    std::vector<int>     widths;
+    int                  tileW = 0, tileH = 0; // Slot size
+};
+
+static void RasterizeTiles(const std::vector<BenchCell>& cells, int scale, LabelTiles& t) {
+    t.tileH = LabelBoxHeight(scale);
+    t.tileW = 0;
+    t.widths.resize(cells.size());
+    for (size_t i = 0; i < cells.size(); ++i) t.tileW = std::max(t.tileW, t.widths[i] = LabelBoxWidth(cells[i].lbl.c_str(), scale));
+    t.masks.assign(cells.size() * t.tileW * t.tileH * 2, 0); // Rasterizers need zeroed masks
+    for (size_t i = 0; i < cells.size(); ++i)
+        RasterizeLabel(cells[i].lbl.c_str(), scale, &t.masks[i * t.tileW * t.tileH * 2], t.widths[i] * 2);
+}
+
+// Clear a frame and draw the filtered cells' labels centered in their cells
+static void CompositeLabels(std::vector<uint8_t>& frame, int w, int h, const std::vector<BenchCell>& cells,
+                            const std::vector<BenchCell*>& filtered, const LabelTiles& t) {
+    memset(frame.data(), 0, frame.size());
+    for (const BenchCell* c : filtered) {
+        size_t i = c - cells.data();
+        int mw = t.widths[i];
+        BlitCoverage(frame.data(), w * 4, w, h, c->pt.x - mw / 2, c->pt.y - t.tileH / 2,
+                     &t.masks[i * t.tileW * t.tileH * 2], mw, t.tileH, BENCH_BOX, BENCH_TEXT);
+    }
+}
+
+static bool ReadFile(const char* path, std::string& text) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof buf, f)) > 0) text.append(buf, n);
+    bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+
+static bool WriteFile(const char* path, const std::string& text) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(text.data(), 1, text.size(), f) == text.size();
+    return fclose(f) == 0 && ok;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc % 2 != 0) {
+        fprintf(stderr, "usage: %s out.json [--baseline base.json] [--threshold PERCENT] [--min-delta US] [--iterations N]\n", argv[0]);
+        return 2;
+    }
+    const char* baselinePath = nullptr;
+    double threshold = BENCH_THRESHOLD_PCT; // Allowed slowdown in percent
+    double minDelta = BENCH_MIN_DELTA_US; // ... and in microseconds
+    int iterations = BENCH_ITERATIONS; // Timed samples per scenario
+    for (int i = 2; i + 1 < argc; i += 2) { // Option/value pairs
+        if (strcmp(argv[i], "--baseline") == 0) baselinePath = argv[i + 1];
+        else if (strcmp(argv[i], "--threshold") == 0) threshold = atof(argv[i + 1]);
+        else if (strcmp(argv[i], "--min-delta") == 0) minDelta = atof(argv[i + 1]);
+        else if (strcmp(argv[i], "--iterations") == 0) iterations = std::max(1, atoi(argv[i + 1]));
+        else { fprintf(stderr, "unknown option %s\n", argv[i]); return 2; }
+    }
+    std::vector<BenchResult> baseline; // Previous report to compare against
+    std::string baselineText;
+    if (baselinePath) {
+        if (!ReadFile(baselinePath, baselineText)) { fprintf(stderr, "cannot read %s\n", baselinePath); return 2; }
+        ParseBenchBaseline(baselineText, baseline);
+    }
+
+    std::vector<BenchResult> results;
+    std::vector<BenchCell> cells;
+    std::vector<BenchCell*> filtered;
+    std::vector<LONG> rowEdges, colEdges;
+    std::vector<uint8_t> frame;
+    LabelTiles tiles;
+    const std::wstring none, prefix = L"a", dotted = L"a."; // Typed so far
+
+    // Pool sweep: what one activation and each keystroke cost as the pool grows
+    for (int pool : BENCH_POOLS) {
+        std::string p = "/pool" + std::to_string(pool);
+        results.push_back(BenchRun("generate" + p, iterations, [&] { GenerateBenchCells(cells, pool); }));
+        results.push_back(BenchRun("filter/show_all" + p, iterations, [&] { FilterByPrefix(cells, none, filtered); }));
+        results.push_back(BenchRun("filter/prefix" + p, iterations, [&] { FilterByPrefix(cells, prefix, filtered); }));
+        results.push_back(BenchRun("filter/dotted_prefix" + p, iterations, [&] { FilterByPrefix(cells, dotted, filtered); }));
+        results.push_back(BenchRun("rasterize/labels" + p, iterations, [&] { RasterizeTiles(cells, BENCH_SCALE, tiles); }));
+
+        FilterByPrefix(cells, none, filtered); // The full grid
+        for (const auto& scr : BENCH_SCREENS) {
+            std::string r = p + "/" + scr.name;
+            RECT area = { 0, 0, scr.w, scr.h };
+            POINT focus = { scr.w / 3, scr.h / 3 }; // Off-center, like a cursor
+            results.push_back(BenchRun("layout" + r, iterations, [&] { LayoutGrid(cells, area, pool, nullptr, rowEdges, colEdges); }));
+            results.push_back(BenchRun("layout_foveated" + r, iterations, [&] { LayoutGrid(cells, area, pool, &focus, rowEdges, colEdges); }));
+            LayoutGrid(cells, area, pool, nullptr, rowEdges, colEdges);
+            frame.assign((size_t)scr.w * scr.h * 4, 0);
+            results.push_back(BenchRun("composite" + r, iterations, [&] { CompositeLabels(frame, scr.w, scr.h, cells, filtered, tiles); }));
+        }
+    }
+    frame = std::vector<uint8_t>(); // Fixtures are large: give the memory back
+
+    // Label rasterization at higher DPIs, the click prompt, and the window hotkey's pool fit
+    GenerateBenchCells(cells, 36);
+    for (int scale : { 3, 4, 8 })
+        results.push_back(BenchRun("rasterize/labels/pool36/scale" + std::to_string(scale), iterations,
+                                   [&] { RasterizeTiles(cells, scale, tiles); }));
+    std::vector<uint8_t> prompt;
+    for (int scale : { 2, 4 }) {
+        int w = PromptBoxWidth(PROMPT_TEXT, scale), h = PromptBoxHeight(scale);
+        results.push_back(BenchRun("rasterize/prompt/scale" + std::to_string(scale), iterations, [&] {
+            prompt.assign((size_t)w * h * 2, 0);
+            RasterizePrompt(PROMPT_TEXT, scale, prompt.data(), w, h);
+        }));
+    }
+    for (const auto& scr : BENCH_SCREENS) {
+        RECT area = { 0, 0, scr.w / 2, scr.h / 2 }; // A window a quarter of the screen
+        results.push_back(BenchRun(std::string("fit/") + scr.name, iterations, [&] { g_sink = FittingPool(area, 36, BENCH_SCALE); }));
+    }
+
+    // Screen analysis kernels and target detection on a synthetic desktop at every screen size
+    std::vector<uint8_t> desktop;
+    std::vector<RECT> found;
+    ScreenAnalysis analysis;
+    for (const auto& scr : BENCH_SCREENS) {
+        std::string r = std::string("/") + scr.name;
+        SyntheticDesktop(desktop, scr.w, scr.h);
+        RECT area = { 0, 0, scr.w, scr.h };
+        results.push_back(BenchRun("kernels/half_luma" + r, iterations,
+                                   [&] { AnalyzeImage(analysis, desktop.data(), scr.w * 4, scr.w, scr.h, area); }));
+        analysis.blocks.resize((size_t)(analysis.lw / TARGET_BLOCK) * (analysis.lh / TARGET_BLOCK));
+        results.push_back(BenchRun("kernels/edge_blocks" + r, iterations,
+                                   [&] { EdgeBlocks(analysis.luma.data(), analysis.lw, analysis.lh, analysis.blocks.data()); }));
+        results.push_back(BenchRun("targets" + r, iterations,
+                                   [&] { DetectTargets(analysis, desktop.data(), scr.w * 4, scr.w, scr.h, found); }));
+
+        // Adaptive contrast: luma statistics under every cell of the full grid
+        LayoutGrid(cells, area, 36, nullptr, rowEdges, colEdges);
+        results.push_back(BenchRun("kernels/luma_stats/pool36" + r, iterations, [&] {
+            uint64_t total = 0;
+            for (const BenchCell& c : cells) {
+                uint64_t sum, sumSq;
+                LumaStats(analysis.luma.data(), analysis.lw, c.rc.left / TARGET_SCALE, c.rc.top / TARGET_SCALE,
+                          std::min(analysis.lw, (int)c.rc.right / TARGET_SCALE), std::min(analysis.lh, (int)c.rc.bottom / TARGET_SCALE),
+                          sum, sumSq);
+                total += sum;
+            }
+            g_sink = total;
+        }));
+    }
+
+    // Magnifier kernels: a quarter-size desktop scaled up to fill 4K, far more than any lens
+    {
+        SyntheticDesktop(desktop, 960, 540);
+        std::vector<uint8_t> scaled((size_t)3840 * 2160 * 4);
+        std::vector<uint16_t> rows((size_t)3840 * 8);
+        results.push_back(BenchRun("lens/nearest_x4/4k", iterations, [&] {
+            ScaleNearestBGRA(desktop.data(), 960 * 4, 960, 540, 4, scaled.data(), 3840 * 4, 3840, 2160); }));
+        results.push_back(BenchRun("lens/bilinear_x4/4k", iterations, [&] {
+            ScaleBilinearBGRA(desktop.data(), 960 * 4, 960, 540, 4, scaled.data(), 3840 * 4, 3840, 2160, rows.data()); }));
+    }
+
+    int regressions = 0;
+    std::string text = BenchReport(results, baseline, iterations, threshold, minDelta, {}, regressions);
+    if (!WriteFile(argv[1], text)) { fprintf(stderr, "cannot write %s\n", argv[1]); return 2; }
+    printf("%zu scenarios, %d regression(s)\n", results.size(), regressions);
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,223 @@
+// VimerateStats: offline analyzer for Vimerate's telemetry log (Settings\VimerateTelemetry.bin).
+// Portable C++17, no dependencies: reads the log as a stream in fixed-size chunks and keeps only
+// counters and fixed-size histograms, so memory use does not depend on the log's size.
+//
+//   g++ -O2 -std=c++17 Tools/VimerateStats.cpp -o vimerate-stats
+//   ./vimerate-stats VimerateTelemetry.bin [more.bin ...]   (use - for standard input)
+
+#include <algorithm> // std::min / std::max
+#include <cstdint>   // Fixed-width integers
+#include <cstdio>    // FILE streams and printf
+#include <cstring>   // memcmp
+#include <string>    // std::string for labels
+#ifdef _WIN32
+#include <fcntl.h>   // _O_BINARY
+#include <io.h>      // _setmode
+#endif
+
+// --- Log format (must match Vimerate.cpp) ---
+// A 16-byte header ("VTEL", version, record size, reserved), then 16-byte little-endian records:
+// uint32 ms since app start, uint8 type, uint8 pad, uint16 arg, uint32 a, uint32 b.
+const uint32_t TELEMETRY_VERSION = 1;
+const size_t   RECORD_SIZE = 16;
+enum TelemetryEvent {
+    TEL_PAD,      // Zero padding older versions wrote after a torn write (skipped)
+    TEL_SESSION,  // App started: arg = version, a/b = Unix time low/high
+    TEL_ACTIVATE, // Grid shown: arg = pool size, a = 1 for the window hotkey, b = width << 16 | height
+    TEL_KEY,      // Key while the grid is up: arg = TKEY_*, a = typed length afterwards
+    TEL_JUMP,     // Label completed: arg = label length, a = 1 if it picked a drag's drop point
+    TEL_ACTION,   // Mouse action: arg = TACT_*
+    TEL_HIDE,     // Grid hidden (action, Escape, Backspace on empty input or the hotkey again)
+    TEL_REPLAY,   // History hotkey: arg = slot
+    TEL_FRAME,    // Frame presented: arg = quality | 0x100 for a full-grid frame, a = raster us, b = present us
+    TEL_DROPPED,  // Records lost to a full buffer: a = count
+    TEL_TYPES
+};
+enum TelemetryKey { TKEY_LABEL, TKEY_BACKSPACE };
+const char* const ACTION_NAMES[] = { "?", "left", "right", "double", "middle", "scroll", "drag" };
+const char* const QUALITY_NAMES[] = { "full", "hard_edges", "square_boxes", "sparse_labels" };
+const int ACTION_KINDS = 7;
+const int QUALITY_LEVELS = 4;
+const int MAX_POOL = 64;
+
+// Log-linear histogram: exact below 8, then 8 buckets per power of two (quantiles within 6%)
+struct Histogram {
+    static const int BUCKETS = 8 + 61 * 8;
+    uint64_t counts[BUCKETS] = {};
+    uint64_t n = 0, min = UINT64_MAX, max = 0;
+    double   sum = 0;
+
+    static int Bucket(uint64_t v) {
+        if (v < 8) return (int)v;
+        int e = 3;
+        while (e < 63 && (v >> (e + 1))) ++e; // Highest set bit
+        return (e - 2) * 8 + (int)((v >> (e - 3)) & 7);
+    }
+    static double Mid(int b) { // Middle of a bucket's value range
+        if (b < 8) return b;
+        int e = b / 8 + 2, sub = b % 8;
+        double lo = (double)((uint64_t)(8 + sub) << (e - 3));
+        return lo + ((double)((uint64_t)1 << (e - 3)) - 1) / 2;
+    }
+    void Add(uint64_t v) {
+        ++counts[Bucket(v)];
+        ++n;
+        sum += (double)v;
+        if (v < min) min = v;
+        if (v > max) max = v;
+    }
+    double Quantile(double q) const {
+        uint64_t rank = (uint64_t)(q * (double)(n - 1)), seen = 0;
+        for (int b = 0; b < BUCKETS; ++b) // Clamped, so a bucket's middle never exceeds the observed range
+            if ((seen += counts[b]) > rank) return std::min((double)max, std::max((double)min, Mid(b)));
+        return (double)max;
+    }
+};
+
+// Everything the report shows
+struct Stats {
+    uint64_t files = 0, records = 0, unknown = 0, dropped = 0, sessions = 0;
+    uint64_t activations = 0, windowActivations = 0, abandoned = 0, jumps = 0, replays = 0;
+    uint64_t labelKeys = 0, backspaces = 0;
+    uint64_t actions[ACTION_KINDS] = {};
+    uint64_t pools[MAX_POOL + 1] = {};
+    uint64_t frames[QUALITY_LEVELS] = {};
+    Histogram keysPerJump, hotkeyToJump, hotkeyToClick, fullFrameUs, frameUs;
+
+    // Open activation: the grid is up
+    bool     open = false, jumped = false, clicked = false;
+    uint32_t openMs = 0;
+    uint64_t keys = 0;
+};
+
+static uint32_t U32(const unsigned char* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static uint16_t U16(const unsigned char* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+// Fold one record into the statistics
+static void Consume(Stats& s, const unsigned char* r) {
+    uint32_t ms = U32(r), a = U32(r + 8), b = U32(r + 12);
+    int type = r[4];
+    uint16_t arg = U16(r + 6);
+    ++s.records;
+    switch (type) {
+    case TEL_PAD: break;
+    case TEL_SESSION: // Times restart; an activation open at a crash is dropped
+        ++s.sessions;
+        s.open = false;
+        break;
+    case TEL_ACTIVATE:
+        ++s.activations;
+        if (a) ++s.windowActivations;
+        ++s.pools[arg <= MAX_POOL ? arg : 0];
+        s.open = true; s.jumped = s.clicked = false;
+        s.openMs = ms;
+        s.keys = 0;
+        break;
+    case TEL_KEY:
+        if (arg == TKEY_BACKSPACE) ++s.backspaces; else ++s.labelKeys;
+        if (s.open && !s.jumped) ++s.keys;
+        break;
+    case TEL_JUMP:
+        ++s.jumps;
+        if (s.open && !s.jumped) {
+            s.jumped = true;
+            s.keysPerJump.Add(s.keys);
+            s.hotkeyToJump.Add(ms - s.openMs);
+        }
+        break;
+    case TEL_ACTION:
+        ++s.actions[arg < ACTION_KINDS ? arg : 0];
+        if (s.open && !s.clicked) {
+            s.clicked = true;
+            s.hotkeyToClick.Add(ms - s.openMs);
+        }
+        break;
+    case TEL_HIDE:
+        if (s.open && !s.jumped) ++s.abandoned;
+        s.open = false;
+        break;
+    case TEL_REPLAY: ++s.replays; break;
+    case TEL_FRAME:
+        ++s.frames[(arg & 0xFF) < QUALITY_LEVELS ? (arg & 0xFF) : 0];
+        s.frameUs.Add((uint64_t)a + b);
+        if (arg & 0x100) s.fullFrameUs.Add((uint64_t)a + b);
+        break;
+    case TEL_DROPPED: s.dropped += a; break;
+    default: ++s.unknown; break; // Newer writer or damaged data
+    }
+}
+
+// Stream one log through Consume in 1 MB chunks; false if it isn't a telemetry log
+static bool ReadLog(Stats& s, const char* path) {
+    FILE* f = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+#ifdef _WIN32
+    if (f == stdin) _setmode(_fileno(stdin), _O_BINARY); // Text mode would translate CR LF and stop at 0x1A
+#endif
+    if (!f) { fprintf(stderr, "%s: cannot open\n", path); return false; }
+
+    unsigned char header[RECORD_SIZE];
+    bool ok = fread(header, 1, RECORD_SIZE, f) == RECORD_SIZE && memcmp(header, "VTEL", 4) == 0 &&
+              U32(header + 8) == RECORD_SIZE;
+    if (!ok) fprintf(stderr, "%s: not a Vimerate telemetry log\n", path);
+    else if (U32(header + 4) > TELEMETRY_VERSION) fprintf(stderr, "%s: version %u is newer than this tool\n", path, U32(header + 4));
+
+    static unsigned char chunk[65536 * RECORD_SIZE];
+    size_t got;
+    while (ok && (got = fread(chunk, 1, sizeof(chunk), f)) > 0) { // A torn last record is ignored
+        for (size_t i = 0; i + RECORD_SIZE <= got; i += RECORD_SIZE) Consume(s, chunk + i);
+        if (got % RECORD_SIZE) break;
+    }
+    if (f != stdin) fclose(f);
+    s.open = false; // Activations don't span files
+    if (ok) ++s.files;
+    return ok;
+}
+
+// One histogram row: values are divided by 'scale' for display
+static void PrintRow(const char* name, const Histogram& h, double scale) {
+    if (!h.n) { printf("%-28s %10s\n", name, "-"); return; }
+    printf("%-28s %10llu %10.2f %10.2f %10.2f %10.2f %10.2f\n", name, (unsigned long long)h.n, h.sum / h.n / scale,
+           h.Quantile(0.5) / scale, h.Quantile(0.9) / scale, h.Quantile(0.99) / scale, h.max / scale);
+}
+
+static double Percent(uint64_t part, uint64_t whole) { return whole ? 100.0 * part / whole : 0.0; }
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s VimerateTelemetry.bin [more.bin ...]   (- reads standard input)\n", argv[0]);
+        return 2;
+    }
+    static Stats s; // Large histograms: keep them off the stack
+    bool ok = true;
+    for (int i = 1; i < argc; ++i) ok = ReadLog(s, argv[i]) && ok;
+
+    printf("Files %llu, records %llu, app starts %llu, dropped %llu, unknown %llu\n\n",
+           (unsigned long long)s.files, (unsigned long long)s.records, (unsigned long long)s.sessions,
+           (unsigned long long)s.dropped, (unsigned long long)s.unknown);
+    printf("Activations   %llu (window hotkey %llu), abandoned %llu (%.1f%%)\n", (unsigned long long)s.activations,
+           (unsigned long long)s.windowActivations, (unsigned long long)s.abandoned, Percent(s.abandoned, s.activations));
+    printf("Jumps         %llu, history replays %llu\n", (unsigned long long)s.jumps, (unsigned long long)s.replays);
+    printf("Keystrokes    %llu label, %llu backspace (%.1f%% backspace rate)\n", (unsigned long long)s.labelKeys,
+           (unsigned long long)s.backspaces, Percent(s.backspaces, s.labelKeys + s.backspaces));
+
+    std::string line;
+    for (int k = 1; k < ACTION_KINDS; ++k)
+        line += std::string(line.empty() ? "" : ", ") + ACTION_NAMES[k] + " " + std::to_string(s.actions[k]);
+    printf("Actions       %s\n", line.c_str());
+    line.clear();
+    for (int p = MAX_POOL; p > 0; --p)
+        if (s.pools[p]) line += std::string(line.empty() ? "" : ", ") + std::to_string(p) + ": " + std::to_string(s.pools[p]);
+    printf("Pool sizes    %s\n", line.empty() ? "-" : line.c_str());
+    line.clear();
+    for (int q = 0; q < QUALITY_LEVELS; ++q)
+        line += std::string(line.empty() ? "" : ", ") + QUALITY_NAMES[q] + " " + std::to_string(s.frames[q]);
+    printf("Frame quality %s\n\n", line.c_str());
+
+    printf("%-28s %10s %10s %10s %10s %10s %10s\n", "", "count", "mean", "p50", "p90", "p99", "max");
+    PrintRow("keystrokes per jump", s.keysPerJump, 1);
+    PrintRow("hotkey to jump (ms)", s.hotkeyToJump, 1);
+    PrintRow("hotkey to click (ms)", s.hotkeyToClick, 1);
+    PrintRow("full-grid frame (ms)", s.fullFrameUs, 1000);
+    PrintRow("any frame (ms)", s.frameUs, 1000);
+    return ok ? 0 : 1;
+}
@@ -17,6 +17,18 @@
 #include <shlobj.h>      // Shell utility functions
 #include <commctrl.h>    // Common controls (trackbar, combobox)
 #include <algorithm>     // Standard algorithms (sort, unique)
+#include <cwctype>       // Wide character classification (towlower)
+#include <new>           // Replaceable allocation functions (allocation accounting)
+#include <cstdlib>       // malloc/free behind operator new
+#include <cstdint>       // Fixed-width integers for image kernels
+#include "Core/Kernels.h" // SSE2 pixel kernels: screen analysis and magnifier scaling
+#include "Core/Font.h"    // Built-in bitmap font for labels and the prompt
+#include "Core/InputPlan.h" // Mouse actions as timed input events, and the action command parser
+#include "Core/Grid.h"    // Labels, cell geometry and the key state machine, shared with the X11 frontend
+#include "Core/Targets.h" // Content-aware target detection and label placement
+#include "Core/Handoff.h" // Lock-free triple buffer for frame requests
+#include "Core/Commands.h" // Command pipe protocol, shared with the X11 socket
+#include "Core/Bench.h"   // Benchmark timing and reports, shared with vimerate-bench
 
 // Link necessary libraries for the project
 #pragma comment(lib, "gdiplus.lib")   // Link GDI+ library
@@ -25,6 +37,11 @@
 
 // --- Constants for System Tray Icon and Menu Items ---
 #define WM_APP_NOTIFYICON (WM_APP + 1) // Custom message for tray icon events
+#define WM_APP_PRESENT    (WM_APP + 2) // Render thread finished a back buffer (wParam = buffer index)
+#define WM_APP_SETTINGS   (WM_APP + 3) // Settings thread published a snapshot (to the overlay)
+#define WM_APP_SHOW_SETTINGS  (WM_APP + 4) // Bring the settings window forward (to the settings thread)
+#define WM_APP_HOTKEY_NOTICE  (WM_APP + 5) // Hotkey not registered (wParam = reverted, lParam = PackHotkey)
+#define WM_APP_CLOSE_SETTINGS (WM_APP + 6) // Destroy the settings window and end its thread
 #define IDM_EXIT          1001         // ID for 'Exit' menu item
 #define IDM_SETTINGS      1002         // ID for 'Settings' menu item
 // --- End Constants ---
@@ -51,6 +68,21 @@ const wchar_t INI_KEY_POOL_SIZE[] = L"PoolSize";       // INI key for pool size
 const wchar_t INI_KEY_HOTKEY_MOD1[] = L"HotkeyMod1";   // INI key for first hotkey modifier
 const wchar_t INI_KEY_HOTKEY_MOD2[] = L"HotkeyMod2";   // INI key for second hotkey modifier
 const wchar_t INI_KEY_HOTKEY_VKEY[] = L"HotkeyVKey";   // INI key for hotkey virtual key
+const wchar_t INI_KEY_WINDOW_VKEY[] = L"HotkeyWindowVKey"; // INI key for the window-scoped grid key
+const wchar_t INI_KEY_REPEAT_VKEY[] = L"HotkeyRepeatVKey"; // INI key for the repeat-last-jump key
+const wchar_t INI_KEY_DIAGNOSTICS[] = L"Diagnostics";  // INI key for per-frame timing output (debugger log)
+const wchar_t INI_KEY_DUMP_FRAMES[] = L"DumpFrames";   // INI key for writing every presented frame to disk
+const wchar_t INI_KEY_COMMAND_PIPE[] = L"CommandPipe"; // INI key for enabling the local command pipe
+const wchar_t INI_KEY_SMART_TARGETS[] = L"SmartTargets"; // INI key for placing labels on detected targets
+const wchar_t INI_KEY_ADAPTIVE_CONTRAST[] = L"AdaptiveContrast"; // INI key for per-cell label colors
+const wchar_t INI_KEY_FOVEATED_LAYOUT[] = L"FoveatedLayout"; // INI key for smaller cells around the cursor
+const wchar_t INI_KEY_MAGNIFIER[] = L"Magnifier";      // INI key for the zoom lens next to the click prompt
+const wchar_t INI_KEY_MAGNIFIER_ZOOM[] = L"MagnifierZoom"; // INI key for the lens zoom factor
+const wchar_t INI_KEY_MAGNIFIER_BILINEAR[] = L"MagnifierBilinear"; // INI key for smooth instead of blocky zoom
+const wchar_t INI_KEY_FRAME_BUDGET[] = L"FrameBudgetMs"; // INI key for the frame-time governor's budget (0 = off)
+const wchar_t INI_KEY_TELEMETRY[] = L"Telemetry";      // INI key for the session telemetry log
+const wchar_t INI_KEY_HISTORY_HOTKEYS[] = L"HistoryHotkeys"; // INI key for the repeat and slot hotkeys (opt-in)
+const wchar_t COMMAND_PIPE_NAME[] = L"\\\\.\\pipe\\Vimerate"; // Local command endpoint
 // --- End Constants ---
 
 // Global window handles
@@ -66,44 +98,371 @@ const int DEFAULT_POOL_SIZE = 36;             // Default number of characters in
 UINT g_hotkeyMod1 = MOD_WIN;    // First hotkey modifier (default: Win)
 UINT g_hotkeyMod2 = MOD_SHIFT;  // Second hotkey modifier (default: Shift)
 UINT g_hotkeyVKey = 'Z';        // Hotkey virtual key (default: 'Z')
+UINT g_hotkeyWindowVKey = 'X';  // Same modifiers + this key: grid over the foreground window
+UINT g_hotkeyRepeatVKey = 'R';  // Same modifiers + this key: replay the last jump
 
 // Default hotkey constants for reset
 const UINT DEFAULT_HOTKEY_MOD1 = MOD_WIN;   // Default first modifier
 const UINT DEFAULT_HOTKEY_MOD2 = MOD_SHIFT; // Default second modifier
 const UINT DEFAULT_HOTKEY_VKEY = 'Z';       // Default virtual key
-
-// Grid state enumeration
-enum GridState { HIDDEN, SHOW_ALL, WAIT_CLICK } g_state = HIDDEN; // Current grid display state
-std::wstring    g_typed;                // User's typed input string
-struct Cell { std::wstring lbl; RECT rc; }; // Structure for a single grid cell
+const UINT DEFAULT_WINDOW_VKEY = 'X';       // Default window-mode virtual key
+const UINT DEFAULT_REPEAT_VKEY = 'R';       // Default repeat-jump virtual key
+
+// Settings window thread: it edits its own copy and hands finished copies to the overlay
+struct SettingsSnapshot {
+    Gdiplus::Color cellColor;  // Cell color
+    int  poolSize;             // Characters in the label pool
+    UINT mod1, mod2, vkey;     // Main hotkey
+};
+SettingsSnapshot  g_settingsView;                       // Settings thread only: what its controls show
+void* volatile    g_pendingSettings = nullptr;          // Newest published SettingsSnapshot the overlay hasn't applied
+HANDLE            g_settingsThread = nullptr;           // Hosts the settings window and its modal dialogs
+
+// Grid state, typed input and pending drag (Core/Grid.h)
+GridSession     g_grid;
+// Grid cell: label, label box area, jump target, and per-cell colors (0 = use the defaults)
+struct Cell { std::wstring lbl; RECT rc; POINT pt; Gdiplus::ARGB box = 0, text = 0; };
 std::vector<Cell>     g_cells;        // All possible grid cells
 std::vector<Cell*>    g_filtered;     // Cells matching user's input
 const UINT      HOTKEY_ID   = 1;      // Unique ID for the registered hotkey
-const std::wstring POOL     = L"abcdefghijklmnopqrstuvwxyz0123456789"; // Character pool
+const UINT      HOTKEY_ID_WINDOW = 2; // ID for the window-scoped grid hotkey
+const UINT      HOTKEY_ID_REPEAT = 3; // ID for the repeat-last-jump hotkey
+const UINT      HOTKEY_ID_SLOT   = 4; // IDs 4..12: jump to history slot 1..9 (modifiers + digit)
+RECT            g_gridRect = { 0, 0, 0, 0 }; // Screen area the grid covers (captured when the hotkey fires)
+// Character pool (POOL) and the grid model live in Core/Grid.h
+
+// Mouse actions (InputAction) and their planning live in Core/InputPlan.h
+
+// Jump history: recent targets with the action taken there, most recent first. Replayed by hotkey
+// without showing or drawing the grid; persisted in Settings\VimerateHistory.bin.
+const int      HISTORY_SIZE = 9;       // Slots (one per digit hotkey)
+const uint32_t HISTORY_VERSION = 1;    // Bump when the file layout changes
+struct JumpRecord {
+    POINT       pt = { 0, 0 };         // Where the cursor was sent
+    bool        hasAction = false;     // An action was taken there (else replay only moves)
+    InputAction action;                // Click or scroll performed at pt
+};
+JumpRecord g_history[HISTORY_SIZE];    // Fixed size: recording never allocates
+int        g_historyCount = 0;         // Valid entries
+bool       g_historyDirty = false;     // Changed since the file was last written
+const UINT HISTORY_TIMER_ID = 2;       // Debounced history write on the grid window
+const UINT HISTORY_SAVE_MS = 2000;     // Quiet time before a changed history is written
+bool       g_historyHotkeys = false;   // Register the repeat and slot hotkeys (they shadow shell shortcuts)
+
+// Session telemetry (opt-in): fixed-size records appended to Settings\VimerateTelemetry.bin and read
+// by Tools/VimerateStats.cpp, which holds the same format definition. The UI thread only fills a
+// slot of a single-producer ring; a flush thread writes whatever is there in one batch per wake-up.
+// A full ring drops records (and counts them) rather than ever making input wait for the disk.
+const uint32_t TELEMETRY_VERSION = 1;     // Bump when the record layout changes
+const ULONG    TELEMETRY_RING = 4096;     // Ring slots (power of two)
+const DWORD    TELEMETRY_FLUSH_MS = 1000; // Longest a record waits in the ring
+enum TelemetryEvent : uint8_t {
+    TEL_PAD,      // Reserved: zero padding older versions wrote after a torn write (never logged)
+    TEL_SESSION,  // App started: arg = version, a/b = Unix time low/high
+    TEL_ACTIVATE, // Grid shown: arg = pool size, a = 1 for the window hotkey, b = width << 16 | height
+    TEL_KEY,      // Key while the grid is up: arg = TKEY_*, a = typed length afterwards
+    TEL_JUMP,     // Label completed: arg = label length, a = 1 if it picked a drag's drop point
+    TEL_ACTION,   // Mouse action: arg = TACT_*
+    TEL_HIDE,     // Grid hidden (action, Escape, Backspace on empty input or the hotkey again)
+    TEL_REPLAY,   // History hotkey: arg = slot
+    TEL_FRAME,    // Frame presented: arg = quality | 0x100 for a full-grid frame, a = raster us, b = present us
+    TEL_DROPPED   // Records lost to a full ring: a = count (written by the flush thread)
+};
+enum TelemetryKey { TKEY_LABEL, TKEY_BACKSPACE };
+enum TelemetryAction { TACT_LEFT = 1, TACT_RIGHT, TACT_DOUBLE, TACT_MIDDLE, TACT_SCROLL, TACT_DRAG };
+struct TelemetryRecord {   // 16 bytes, little-endian on disk as in memory
+    uint32_t ms;           // Milliseconds since the app started
+    uint8_t  type;         // TelemetryEvent
+    uint8_t  pad;
+    uint16_t arg;          // Small per-event value
+    uint32_t a, b;         // Per-event values
+};
+struct TelemetryLog {
+    TelemetryRecord ring[TELEMETRY_RING];
+    volatile LONG   head = 0;           // Next slot to fill (UI thread writes)
+    volatile LONG   tail = 0;           // Next slot to flush (flush thread writes)
+    volatile LONG   dropped = 0;        // Records lost since the last flush
+    HANDLE          file = INVALID_HANDLE_VALUE;
+    HANDLE          thread = nullptr;   // Flush thread (null: telemetry off)
+    HANDLE          wake = nullptr;     // Auto-reset: ring half full, or time to stop
+    volatile bool   quit = false;       // Final flush, then exit
+    ULONGLONG       startMs = 0;        // GetTickCount64 at startup
+};
+TelemetryLog g_telemetry;
+bool         g_telemetryEnabled = false; // INI switch
+
+// Frame-time governor: when full-grid frames overrun the budget, rendering steps down a quality
+// level at a time, and back up once frames are comfortably fast again. Levels are cumulative.
+enum RenderQuality {
+    QUALITY_FULL,   // Antialiased label edges, lens as configured
+    QUALITY_HARD,   // Label edges thresholded instead of blended; nearest-neighbor lens
+    QUALITY_SQUARE, // Solid square label boxes
+    QUALITY_SPARSE, // Full grid shows every other label (typing still filters all of them)
+    QUALITY_LEVELS
+};
+const char* const QUALITY_NAMES[QUALITY_LEVELS] = { "full", "hard_edges", "square_boxes", "sparse_labels" };
+const int    DEFAULT_FRAME_BUDGET_MS = 33; // Two frames at 60 Hz
+const int    GOVERNOR_UP_FRAMES = 4;       // Fast full-grid frames in a row before stepping back up
+const double GOVERNOR_HEADROOM = 0.5;      // "Fast": under this fraction of the budget
+int g_frameBudgetMs = DEFAULT_FRAME_BUDGET_MS; // 0 disables the governor
+int g_quality = QUALITY_FULL;              // Level new frames are built with (UI thread)
+int g_qualityCalm = 0;                     // Fast full-grid frames in a row (UI thread)
 
 // Current pool size, initialized to full pool length
 int             g_poolSize = (int)POOL.length();
-const int MIN_POOL_SIZE = 6; // Minimum characters allowed in pool
+int             g_gridPool = (int)POOL.length(); // Pool of the cells in g_cells: g_poolSize, lowered to fit a small window
+bool            g_gridInWindow = false;          // g_gridRect is the foreground window, not the screen
+
+// Persistent presentation surface: a DIB section shared with the compositor, reused across frames
+struct Surface {
+    HDC     dc = nullptr;      // Memory DC holding the bitmap
+    HBITMAP bmp = nullptr;     // DIB section (top-down, 32bpp premultiplied BGRA)
+    HBITMAP oldBmp = nullptr;  // Bitmap originally selected into dc
+    void*   bits = nullptr;    // Pixel memory, written directly by the renderer
+    int     w = 0, h = 0;      // Current size in pixels
+};
+
+// One visible cell as the render thread sees it: a copy, so the UI thread can regenerate cells freely
+struct DrawCell {
+    RECT    rc;      // Cell rectangle (screen coordinates)
+    int     row;     // Grid row (= render band)
+    wchar_t lbl[4];  // Null-terminated label
+    int     atlas;   // Label's atlas entry
+    Gdiplus::ARGB box, text; // Box and text colors
+};
+
+// Everything needed to draw one frame, snapshotted on the UI thread; holds no pointers into UI state
+struct FrameRequest {
+    LONG                  seq = 0;          // Publication order (UI thread counter)
+    HWND                  target = nullptr; // Window the finished frame is presented on
+    RECT                  area = {};        // Screen area the grid covers
+    RECT                  frame = {};       // Screen region to rasterize
+    int                   rows = 1;         // Grid rows (= bands)
+    std::vector<LONG>     rowEdges;         // rows + 1 band boundaries (screen y)
+    Gdiplus::Color        color;            // Cell box color
+    int                   quality = QUALITY_FULL; // Governor level the frame is drawn at
+    bool                  prompt = false;   // Draw the click prompt
+    RECT                  promptRc = {};    // Prompt placement
+    bool                  lens = false;     // Draw the magnifier lens
+    RECT                  lensRc = {};      // Lens placement
+    int                   lensZoom = 1;     // Lens pixels per source pixel
+    bool                  lensBilinear = false; // Smooth instead of nearest-neighbor scaling
+    int                   lensSide = 0;     // Source square edge in pixels
+    std::vector<BYTE>     lensPixels;       // Source square around the cursor (BGRA, tightly packed)
+    std::vector<DrawCell> cells;            // Visible cells in row-major order
+};
+
+// Render thread handoff: requests are triple-buffered (Core/Handoff.h). The UI thread fills
+// g_handoff.producer and publishes it; the render thread takes the newest into g_handoff.consumer.
+Handoff<FrameRequest> g_handoff;
+LONG                  g_requestSeq = 0; // Last published sequence number (UI thread)
+
+// Back buffer: rendered by the render thread, then owned by the UI thread until it is presented
+struct RenderBuffer {
+    Surface       surface;    // Pixels (grows, never shrinks)
+    RECT          frame = {}; // Screen region the pixels show
+    LONG          seq = 0;    // Request the pixels were rendered from
+    double        rasterMs = 0; // Raster time, for diagnostics
+    int           quality = QUALITY_FULL; // Governor level it was drawn at
+    bool          fullGrid = false; // Whole grid area with labels: what the governor measures
+    volatile LONG ready = 0;  // 1 from "rendered" until the UI thread has presented it
+};
+RenderBuffer    g_buffers[2];           // Double buffering: one can be drawn while the other is shown
+HANDLE          g_renderThread = nullptr; // Render thread (none in --render/--bench runs)
+HANDLE          g_renderWake = nullptr;   // Auto-reset: a request was published
+HANDLE          g_bufferFreed = nullptr;  // Auto-reset: the UI thread returned a buffer
+volatile bool   g_renderQuit = false;     // Tells the render thread to exit
+LONG            g_presentedSeq = 0;       // Newest request on screen (UI thread)
+
+// Persistent worker pool for banded rendering (the calling thread also takes part)
+typedef void (*BandFn)(void* ctx, int band);             // Work item: render one band
+struct WorkerPool {
+    std::vector<HANDLE> threads;      // Worker threads
+    HANDLE        startSem = nullptr; // Released once per worker per job
+    HANDLE        doneEvent = nullptr;// Signaled when the last permit holder finishes
+    volatile LONG nextBand = 0;       // Next unclaimed band (shared queue, claimed dynamically)
+    volatile LONG pending = 0;        // Permits still running the current job
+    int           bandCount = 0;      // Bands in the current job
+    BandFn        fn = nullptr;       // Current job function
+    void*         ctx = nullptr;      // Current job context
+    volatile bool quit = false;       // Tells workers to exit
+};
+WorkerPool g_pool;
 
 // System tray notification icon data
 NOTIFYICONDATAW g_nid = {};
 
-// Full path to the settings INI file
+// Per-frame scratch memory: bump-allocated, reset after presentation.
+// Overflow blocks keep earlier pointers valid; Reset folds them into one larger block for next time.
+struct FrameArena {
+    std::vector<std::vector<BYTE>> blocks; // blocks.back() is the block being filled
+    size_t used = 0;                       // Bytes used in blocks.back()
+
+    void* Alloc(size_t size, size_t align) {
+        if (!blocks.empty()) {
+            size_t off = (used + align - 1) & ~(align - 1);
+            if (off + size <= blocks.back().size()) { used = off + size; return blocks.back().data() + off; }
+        }
+        blocks.emplace_back(std::max(size + align, (size_t)65536)); // Overflow: new block, old ones stay put
+        size_t off = ((size_t)(-(intptr_t)blocks.back().data())) & (align - 1);
+        used = off + size;
+        return blocks.back().data() + off;
+    }
+    template <typename T> T* Alloc(size_t count) { return (T*)Alloc(count * sizeof(T), alignof(T)); }
+
+    void Reset() {
+        if (blocks.size() > 1) { // Frame overflowed: replace with one block big enough for all of it
+            size_t total = 0;
+            for (auto& b : blocks) total += b.size();
+            blocks.clear();
+            blocks.emplace_back(total);
+        }
+        used = 0;
+    }
+};
+FrameArena g_frameArena;
+
+// Heap allocations made through operator new since startup (all threads)
+volatile LONG g_allocCount = 0;
+// Nesting depth of UncountedScope on this thread; its allocations are not counted while > 0
+thread_local int t_uncountedDepth = 0;
+
+// Full path to the settings INI file and its directory
 std::wstring g_iniFilePath;
+std::wstring g_settingsDir;
+
+// Diagnostics switches (INI only, no UI)
+bool g_diagnostics = false;  // Log frame timings with OutputDebugString
+bool g_dumpFrames = false;   // Write each presented frame to Settings\Frames
+int  g_frameCounter = 0;     // Sequence number for dumped frames
+bool g_commandPipe = false;  // Serve headless commands on COMMAND_PIPE_NAME
+volatile LONG g_pipePoolSize = 0; // Pool size the pipe thread resolves with (published by the UI thread)
+bool g_smartTargets = false; // Place labels on targets detected in a screen capture
+bool g_adaptiveContrast = false; // Pick label colors from the screen behind each cell
+bool g_contrastDirty = false;    // Cell colors need recomputing at the next layout
+bool g_foveated = false;         // Shrink cells around the cursor, grow them at the edges
+POINT g_focus = { 0, 0 };        // Foveation center: cursor position at activation
+
+std::vector<LONG> g_rowEdges;        // Current layout: g_gridPool + 1 row boundaries (screen y)
+std::vector<LONG> g_colEdges;        // Current layout: 2 * g_gridPool + 1 column boundaries (screen x)
+
+// Content-aware targets: detection, tuning and label placement live in Core/Targets.h
+ScreenAnalysis    g_analysis; // Luma plane and detector buffers, reused across activations
+std::vector<RECT> g_targets;  // Targets found at the last activation (screen coordinates)
+Surface           g_capture;  // Screen capture for analysis (grows, never shrinks)
+
+// Magnifier: a zoomed copy of the screen around the cursor, shown next to the click prompt and
+// refreshed on a timer while the prompt is open
+const int  LENS_SIZE = 160;          // Lens edge in pixels
+const int  LENS_MARGIN = 8;          // Gap between prompt and lens
+const int  MIN_LENS_ZOOM = 2;        // Smallest zoom factor
+const int  MAX_LENS_ZOOM = MAX_SCALE_ZOOM; // Largest zoom factor (the scale kernels' limit)
+const int  DEFAULT_LENS_ZOOM = 4;    // Default zoom factor
+const UINT LENS_TIMER_ID = 1;        // Refresh timer on the grid window
+const UINT LENS_REFRESH_MS = 16;     // About one refresh per display frame
+bool    g_magnifier = false;         // Show the lens in WAIT_CLICK
+int     g_lensZoom = DEFAULT_LENS_ZOOM; // Current zoom factor (+/- while the prompt is open)
+bool    g_lensBilinear = false;      // Bilinear instead of nearest-neighbor scaling
+Surface g_lensCapture;               // Screen square around the cursor (sized for the smallest zoom)
+int     g_lensSide = 0;              // Edge of the captured square (0 = nothing captured)
+
+// Label atlas: every label of the full alphabet pre-rendered as box and text coverage masks,
+// colorized while blitting. Persisted in Settings\LabelAtlas.bin and memory-mapped at startup.
+const uint32_t ATLAS_VERSION = 4;            // Bump when the file layout or the drawing changes
+struct AtlasHeader {
+    char     magic[4];      // "VLAT"
+    uint32_t version;       // ATLAS_VERSION
+    uint32_t alphabetHash;  // FNV-1a of POOL
+    uint32_t fontHash;      // FNV-1a of face, size and style
+    uint32_t dpi;           // Screen DPI the masks were rendered at
+    uint32_t labels;        // Entries (every label of the full alphabet)
+    uint32_t tileW, tileH;  // Mask tile size in pixels
+    uint32_t payloadSize;   // Bytes after the header
+    uint32_t checksum;      // FNV-1a of the entry table (each tile has its own, checked when first drawn)
+};
+struct AtlasEntry {
+    float    boxW, boxH;    // Label box size; the box sits at the tile's top-left
+    uint32_t checksum;      // FNV-1a of the label's tile
+    uint32_t reserved;
+};
+struct LabelAtlas {
+    HANDLE             file = INVALID_HANDLE_VALUE; // Mapped file
+    HANDLE             mapping = nullptr;           // File mapping object
+    const BYTE*        view = nullptr;              // Whole file (mapped, or 'memory' if the file can't be written)
+    std::vector<BYTE>  memory;                      // Fallback backing store
+    const AtlasHeader* header = nullptr;
+    const AtlasEntry*  entries = nullptr;           // One per label, in AtlasIndex order
+    const BYTE*        masks = nullptr;             // Per label: tileW x tileH pixels of (box, text) coverage
+    std::vector<void*> tiles;                       // Per label: its checked tile (null until first drawn)
+    volatile LONG      corrupt = 0;                 // A tile failed its checksum: delete the file at unload
+    std::wstring       path;                        // Mapped file's path
+};
+LabelAtlas g_atlas; // Read-only after startup, so render threads share it freely
+
+// Built-in font (Core/Font.h): 5x9 bitmap glyphs drawn at an integer scale
+int       g_fontScale = 2;         // Label scale for the screen DPI (set by LoadLabelAtlas)
 
 // --- Forward Declarations ---
 LRESULT CALLBACK WndProc(HWND, UINT, WPARAM, LPARAM);          // Main window message handler
 LRESULT CALLBACK SettingsWndProc(HWND, UINT, WPARAM, LPARAM);  // Settings window message handler
-void    GenerateCells();                                       // Create all grid cells
+void    GenerateCells(int);                                    // Create all grid cells for a pool size
 void    FilterCells();                                         // Filter cells based on input
-void    LayoutAndDraw(HWND, int, int);                         // Position and draw cells
+void    LayoutCells(const RECT&);                              // Compute cell rectangles for a grid area
+void    CaptureScreen(const RECT&);                            // Capture and analyze the screen under the grid
+void    ApplyCellContrast();                                   // Per-cell label colors from the luma plane
+void    LoadLabelAtlas();                                      // Map the label atlas, rebuilding it if needed
+void    UnloadLabelAtlas();                                    // Unmap the label atlas
+static int  AtlasIndex(const std::wstring&);                   // Atlas entry of a label (-1 if none)
+static void BlitLabel(BYTE*, int, int, int, int, int, int, Gdiplus::ARGB, Gdiplus::ARGB, int); // Composite an atlas label
+static void BlitCoverageHard(BYTE*, int, int, int, int, int, const BYTE*, int, int, int, Gdiplus::ARGB, Gdiplus::ARGB, bool); // Same, without blending
+void    CaptureLens();                                         // Capture the screen around the cursor for the lens
+RECT    LensRect(const RECT&, const RECT&);                    // Magnifier placement next to the prompt
+bool    ReadFrameImage(const std::wstring&, std::vector<BYTE>&, int&, int&); // Load a PPM/PAM as BGRA
+RECT    ScreenRect();                                          // Primary screen as a grid area
+RECT    ForegroundWindowRect(int&);                            // Foreground window as a grid area, and the pool that fits it
+void    StartCommandPipe();                                    // Start the headless command server thread
+void    LayoutAndDraw(HWND, const RECT&);                      // Position, draw and present cells
+RECT    FrameBounds(const RECT&);                              // Screen area the current frame actually draws
+void    BuildFrameRequest(FrameRequest&, const RECT&);         // Snapshot the current state for rendering
+void    RenderFrame(Surface&, const FrameRequest&);            // Rasterize a request into a surface
+void    StartRenderThread();                                   // Start the render thread and its events
+void    StopRenderThread();                                    // Join the render thread
+void    PresentBuffer(HWND, RenderBuffer&);                    // Show a finished buffer and hand it back
+void    HideGrid(HWND);                                        // Hide the overlay and clear its contents
+static void PublishFrameRequest();                             // UI side of the request handoff
+static bool RenderToBuffer(RenderBuffer&, const FrameRequest&); // Rasterize a request into a back buffer
+bool    WriteFrameImage(const Surface&, int, int, const std::wstring&); // Save a surface region as PPM or PAM
+int     RunRenderCommand(int, wchar_t**);                      // --render: offscreen frame to file
+int     RunBenchCommand(int, wchar_t**);                       // --bench: timing sweep with regression gate
+bool    WriteFileBytes(const std::wstring&, const void*, size_t); // Write a whole file
+bool    ReadFileBytes(const std::wstring&, std::string&);      // Read a whole file
+bool    EnsureSurface(Surface&, int, int);                     // (Re)create the surface only on size change
+void    StartWorkerPool();                                     // Create one worker per extra core
+void    StopWorkerPool();                                      // Wake and join the workers, close the pool's handles
+void    RunParallel(int, BandFn, void*);                       // Run bands 0..n-1 across the pool
+void    ReleaseSurface(Surface&);                              // Free the surface
 void    MoveToAndPrompt(Cell*);                                // Move mouse and show click prompt
-void    SimClick(DWORD);                                       // Simulate mouse click
+void    SimClick(const InputAction&, bool = false);            // Simulate a mouse action (Core/InputPlan.h)
 void    UpdatePoolSizeDisplay(HWND hSettingsWnd);              // Update pool size label
 void    UpdateHotkeyDisplay(HWND hSettingsWnd);                // Update hotkey display label
 void    PopulateHotkeyDropdowns(HWND hSettingsWnd);            // Fill hotkey combo boxes
 bool    RegisterAppHotkey();                                   // Register global hotkey
+static LPARAM PackHotkey();                                    // Main hotkey as a message parameter
+void    RecordJump(POINT);                                     // Put a jump target at the front of the history
+void    RecordJumpAction(const InputAction&);                  // Remember the action taken at the latest jump
+void    ReplayJump(HWND, int);                                 // Jump to a history slot and repeat its action
+void    LoadHistory();                                         // Read the jump history file
+void    SaveHistory();                                         // Write the jump history file
+static void MarkHistoryDirty();                                // Schedule a history write once jumps go quiet
 void    UnregisterAppHotkey();                                 // Unregister global hotkey
+void    StartTelemetry();                                      // Open the telemetry log and start its flush thread
+void    StopTelemetry();                                       // Flush the telemetry log and join its thread
+void    LogEvent(uint8_t, uint16_t, uint32_t, uint32_t);       // Queue a telemetry record (never blocks)
+uint16_t TelemetryActionCode(const InputAction&);              // TACT_* for an action
+void    StartSettingsThread();                                 // Create the (hidden) settings window on its own thread
+void    StopSettingsThread();                                  // Close the settings window and join its thread
+void    PublishSettings();                                     // Settings thread: hand g_settingsView to the overlay
+void    ApplyPendingSettings();                                // Overlay thread: apply the newest published settings
 
 // Helper functions for settings and drawing
 Gdiplus::Color HexToColor(const std::wstring& hex);            // Convert hex string to color
@@ -112,20 +471,6 @@ void LoadSettings();                                           // Load settings
 void SaveSettings();                                           // Save settings to INI
 void ResetToDefaults(HWND hSettingsWnd);                       // Reset all settings to defaults
 
-// Helper to draw a rounded rectangle
-void DrawRounded(Gdiplus::Graphics& g, const Gdiplus::RectF& r, Gdiplus::Brush* brush) {
-    using namespace Gdiplus; // Use GDI+ namespace
-    float radius = 4.0f;     // Corner radius
-    GraphicsPath path;       // Path to define shape
-    // Add arcs for rounded corners
-    path.AddArc(r.X,                  r.Y,                  radius, radius, 180, 90);
-    path.AddArc(r.X + r.Width - radius, r.Y,                  radius, radius, 270, 90);
-    path.AddArc(r.X + r.Width - radius, r.Y + r.Height - radius, radius, radius,   0, 90);
-    path.AddArc(r.X,                  r.Y + r.Height - radius, radius, radius,  90, 90);
-    path.CloseFigure();              // Close the path to form a shape
-    g.FillPath(brush, &path);        // Fill the path with the specified brush
-}
-
 // --- Main Entry Point of the Application ---
 int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int) {
     // Initialize Common Controls for UI elements
@@ -142,6 +487,7 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int) {
         MessageBoxA(nullptr, "Failed to initialize GDI+.", "Error", MB_OK);
         return 1; // Exit with error
     }
+    StartWorkerPool(); // Render workers, sized to the machine's cores
 
     // --- Determine and create path for settings file ---
     wchar_t exePath[MAX_PATH];     // Buffer for executable path
@@ -156,13 +502,35 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int) {
         exeDir = L"."; // Assume current directory
     }
 
-    g_iniFilePath = exeDir;         // Start INI path with EXE dir
-    g_iniFilePath += L"\\Settings"; // Add 'Settings' subfolder
-    CreateDirectoryW(g_iniFilePath.c_str(), nullptr); // Create the directory
-    g_iniFilePath += L"\\VimerateSettings.ini"; // Add INI file name
+    g_settingsDir = exeDir + L"\\Settings"; // 'Settings' subfolder next to the EXE
+    CreateDirectoryW(g_settingsDir.c_str(), nullptr); // Create the directory
+    g_iniFilePath = g_settingsDir + L"\\VimerateSettings.ini"; // Add INI file name
     // --- End custom settings path determination ---
 
     LoadSettings(); // Load settings at application startup
+    LoadHistory(); // Recent jumps for the repeat and slot hotkeys
+    LoadLabelAtlas(); // Pre-rendered labels: no text rasterization when the grid opens
+
+    // --- Command-line tools (run without creating any window) ---
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    if (argv && argc >= 2 && std::wstring(argv[1]) == L"--render") {
+        int rc = RunRenderCommand(argc, argv); // Offscreen render to an image file
+        LocalFree(argv);
+        UnloadLabelAtlas();
+        StopWorkerPool();
+        Gdiplus::GdiplusShutdown(token);
+        return rc;
+    }
+    if (argv && argc >= 2 && std::wstring(argv[1]) == L"--bench") {
+        int rc = RunBenchCommand(argc, argv); // Benchmark sweep, JSON report
+        LocalFree(argv);
+        UnloadLabelAtlas();
+        StopWorkerPool();
+        Gdiplus::GdiplusShutdown(token);
+        return rc;
+    }
+    if (argv) LocalFree(argv);
 
     // --- Register Main Grid Window Class ---
     const wchar_t GRID_CLASS_NAME[] = L"GridClass"; // Name for grid window class
@@ -201,8 +569,15 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int) {
         nullptr, nullptr, hInst, nullptr // Parent, menu, instance, param
     );
 
-    GenerateCells();     // Generate initial grid cells
-    RegisterAppHotkey(); // Register application's global hotkey
+    g_gridRect = ScreenRect(); // Until a hotkey picks an area
+    GenerateCells(g_poolSize); // Generate initial grid cells
+    StartSettingsThread(); // Settings UI and its dialogs never run on the overlay thread
+    if (!RegisterAppHotkey() && g_hSettingsWnd) // The warning is shown by the settings thread
+        PostMessageW(g_hSettingsWnd, WM_APP_HOTKEY_NOTICE, FALSE, PackHotkey());
+    InterlockedExchange(&g_pipePoolSize, g_poolSize); // Before the pipe thread first reads it
+    if (g_commandPipe) StartCommandPipe(); // Headless automation endpoint (opt-in)
+    StartRenderThread(); // Frames are rasterized off the UI thread from here on
+    if (g_telemetryEnabled) StartTelemetry(); // Opt-in usage log
 
     // --- Tray Icon Initialization ---
     g_nid.cbSize = sizeof(NOTIFYICONDATAW); // Size of structure
@@ -224,18 +599,30 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int) {
     }
 
     UnregisterAppHotkey(); // Unregister hotkey before exiting
+    StopSettingsThread(); // WM_DESTROY asked it to close
+    StopRenderThread(); // No more frames; the buffers are ours again
     DestroyWindow(g_hGridWnd); // Destroy main window
+    for (auto& b : g_buffers) ReleaseSurface(b.surface); // Free the overlay back buffers
 
     SaveSettings(); // Save current settings before exit
+    if (g_historyDirty) SaveHistory(); // A write still waiting on its timer, or a jump with no action yet
+    StopTelemetry(); // Write out what is still queued
 
     // --- Delete Tray Icon before exiting ---
     Shell_NotifyIconW(NIM_DELETE, &g_nid); // Remove tray icon
     // --- End Tray Icon ---
 
+    StopWorkerPool(); // Join render workers (idle now; they only ever read a request and the shared atlas)
+    UnloadLabelAtlas();
     Gdiplus::GdiplusShutdown(token); // Shutdown GDI+
     return 0; // Indicate successful exit
 }
 
+// Main hotkey packed into a message parameter (modifiers fit a byte, virtual keys too)
+static LPARAM PackHotkey() {
+    return (LPARAM)(g_hotkeyMod1 | (g_hotkeyMod2 << 8) | (g_hotkeyVKey << 16));
+}
+
 // Helper to register the application's hotkey
 bool RegisterAppHotkey() {
     UINT combinedModifiers = 0; // Combined hotkey modifiers
@@ -247,39 +634,126 @@ bool RegisterAppHotkey() {
 
     if (g_hotkeyVKey != 0) { // If a virtual key is defined
         // Register the hotkey with Windows
-        if (!RegisterHotKey(g_hGridWnd, HOTKEY_ID, combinedModifiers, g_hotkeyVKey)) {
-            // Show warning if hotkey registration fails
-            MessageBoxW(g_hGridWnd, L"Failed to register hotkey. It might be in use by another application.", L"Hotkey Warning", MB_OK | MB_ICONWARNING);
-            return false; // Indicate failure
-        }
+        // Failure is reported by the caller: warnings belong to the settings thread
+        if (!RegisterHotKey(g_hGridWnd, HOTKEY_ID, combinedModifiers, g_hotkeyVKey)) return false;
     }
+    // Window-scoped grid: same modifiers, its own key; optional, so failure is silent
+    if (g_hotkeyWindowVKey != 0 && g_hotkeyWindowVKey != g_hotkeyVKey)
+        RegisterHotKey(g_hGridWnd, HOTKEY_ID_WINDOW, combinedModifiers, g_hotkeyWindowVKey);
+    // Jump history: repeat key and digits 1-9, same modifiers; opt-in, since with the default
+    // Win+Shift they take over shell shortcuts (Win+Shift+digit opens a new taskbar app instance)
+    if (!g_historyHotkeys) return true;
+    if (g_hotkeyRepeatVKey != 0 && g_hotkeyRepeatVKey != g_hotkeyVKey && g_hotkeyRepeatVKey != g_hotkeyWindowVKey)
+        RegisterHotKey(g_hGridWnd, HOTKEY_ID_REPEAT, combinedModifiers, g_hotkeyRepeatVKey);
+    for (int i = 0; i < HISTORY_SIZE; ++i)
+        if (g_hotkeyVKey != (UINT)('1' + i)) RegisterHotKey(g_hGridWnd, HOTKEY_ID_SLOT + i, combinedModifiers, '1' + i);
     return true; // Indicate success
 }
 
 // Helper to unregister the application's hotkey
 void UnregisterAppHotkey() {
     UnregisterHotKey(g_hGridWnd, HOTKEY_ID); // Unregister hotkey by ID
+    UnregisterHotKey(g_hGridWnd, HOTKEY_ID_WINDOW);
+    UnregisterHotKey(g_hGridWnd, HOTKEY_ID_REPEAT);
+    for (int i = 0; i < HISTORY_SIZE; ++i) UnregisterHotKey(g_hGridWnd, HOTKEY_ID_SLOT + i);
 }
 
+// --- Allocation accounting ---
+// Every operator new in the process is counted. GDI+ uses its own heap and is not included.
+void* operator new(size_t size) {
+    if (!t_uncountedDepth) InterlockedIncrement(&g_allocCount);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void  operator delete(void* p) noexcept { free(p); }
+void  operator delete[](void* p) noexcept { free(p); }
+void  operator delete(void* p, size_t) noexcept { free(p); }
+void  operator delete[](void* p, size_t) noexcept { free(p); }
+
+// Excludes this thread's allocations inside it (diagnostic output) from g_allocCount.
+// Per-thread, so another thread's allocations in the meantime are still counted.
+struct UncountedScope {
+    UncountedScope() { ++t_uncountedDepth; }
+    ~UncountedScope() { --t_uncountedDepth; }
+};
+
+// Reports the allocations made while handling one event (Diagnostics=1)
+struct AllocScope {
+    const wchar_t* what;  // Event name for the log line
+    LONG           start; // Counter at scope entry
+    explicit AllocScope(const wchar_t* w) : what(w), start(g_allocCount) {}
+    ~AllocScope() {
+        if (!g_diagnostics) return;
+        LONG n = g_allocCount - start; // Counted before the log line allocates anything
+        std::wstringstream ss;
+        ss << L"Vimerate: " << what << L" allocations " << n << L"\n";
+        OutputDebugStringW(ss.str().c_str());
+    }
+};
+
 // --- Main Window Procedure (WndProc) ---
+// Translate a key press for GridSession: the click prompt reads letters and digits by key position,
+// typing reads the character the key produces in the current keyboard layout
+static GridKey TranslateGridKey(WPARAM vk, LPARAM lParam, wchar_t& ch) {
+    ch = 0;
+    switch (vk) {
+    case VK_ESCAPE: return GKEY_ESCAPE;
+    case VK_BACK:   return GKEY_BACKSPACE;
+    case VK_LEFT:   return GKEY_LEFT;
+    case VK_RIGHT:  return GKEY_RIGHT;
+    case VK_UP:     return GKEY_UP;
+    case VK_DOWN:   return GKEY_DOWN;
+    case VK_OEM_PLUS: case VK_ADD:       return g_magnifier ? GKEY_ZOOM_IN : GKEY_OTHER;
+    case VK_OEM_MINUS: case VK_SUBTRACT: return g_magnifier ? GKEY_ZOOM_OUT : GKEY_OTHER;
+    }
+    if (g_grid.state == WAIT_CLICK) {
+        if ((vk >= '0' && vk <= '9') || (vk >= 'A' && vk <= 'Z')) { ch = (wchar_t)towlower((wint_t)vk); return GKEY_CHAR; }
+        return GKEY_OTHER;
+    }
+    BYTE kbState[256];      // Keyboard state array
+    GetKeyboardState(kbState); // Get current keyboard state
+    wchar_t buf[2];         // Buffer for converted char
+    if (ToUnicode((UINT)vk, HIWORD(lParam), kbState, buf, 1, 0) != 1) return GKEY_OTHER; // Convert virtual key to Unicode char
+    ch = buf[0];
+    return GKEY_CHAR;
+}
+
 LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
     switch (message) {
-    case WM_HOTKEY: // Hotkey pressed message
-        if (wParam == HOTKEY_ID) { // Check if it's our hotkey
-            if (g_state == HIDDEN) { // If grid is hidden, show it
-                g_state = SHOW_ALL; // Set state to show all cells
-                g_typed.clear();    // Clear typed input
+    case WM_HOTKEY: { // Hotkey pressed message
+        AllocScope scope(L"hotkey"); // Per-event allocation counter
+        if (wParam == HOTKEY_ID_REPEAT) { LogEvent(TEL_REPLAY, 0, 0, 0); ReplayJump(hWnd, 0); break; } // Last jump again
+        if (wParam >= HOTKEY_ID_SLOT && wParam < HOTKEY_ID_SLOT + HISTORY_SIZE) {
+            LogEvent(TEL_REPLAY, (uint16_t)(wParam - HOTKEY_ID_SLOT), 0, 0);
+            ReplayJump(hWnd, (int)(wParam - HOTKEY_ID_SLOT));
+            break;
+        }
+        if (wParam == HOTKEY_ID || wParam == HOTKEY_ID_WINDOW) { // Check if it's our hotkey
+            if (g_grid.state == HIDDEN) { // If grid is hidden, show it
+                // Capture the grid area now, before the overlay takes the foreground
+                int pool = 0; // Window grid: the largest pool whose labels fit the window
+                if (wParam == HOTKEY_ID_WINDOW) g_gridRect = ForegroundWindowRect(pool);
+                g_gridInWindow = pool != 0;
+                if (!g_gridInWindow) { g_gridRect = ScreenRect(); pool = g_poolSize; } // Screen, or no usable window
+                if (pool != g_gridPool) GenerateCells(pool); // Labels stay readable in a small window
+                GetCursorPos(&g_focus); // Foveation centers on where the user is working
+                if (g_smartTargets || g_adaptiveContrast) CaptureScreen(g_gridRect); // Must see the screen without the overlay
+                g_grid.Show(); // Full grid, nothing typed, no abandoned drag
+                LogEvent(TEL_ACTIVATE, (uint16_t)g_gridPool, wParam == HOTKEY_ID_WINDOW,
+                         (uint32_t)std::min(g_gridRect.right - g_gridRect.left, 0xFFFFL) << 16 |
+                         (uint32_t)std::min(g_gridRect.bottom - g_gridRect.top, 0xFFFFL));
                 FilterCells();      // Filter cells (shows all)
                 ShowWindow(hWnd, SW_SHOW); // Show the window
-                LayoutAndDraw(hWnd, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN)); // Redraw
+                LayoutAndDraw(hWnd, g_gridRect); // Redraw
                 SetForegroundWindow(hWnd);
                 SetFocus(hWnd); // Fixing a glitch on some desktops
             } else { // If grid is visible, hide it
-                g_state = HIDDEN;      // Set state to hidden
-                ShowWindow(hWnd, SW_HIDE); // Hide the window
+                HideGrid(hWnd);
             }
         }
         break;
+    }
 
     case WM_APP_NOTIFYICON: // Tray icon message
         switch (LOWORD(lParam)) {
@@ -309,18 +783,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
     case WM_COMMAND: // Command message (menu item click)
         if (LOWORD(wParam) == IDM_SETTINGS) { // If 'Settings' clicked
-            if (g_hSettingsWnd == nullptr) { // If settings window not open, create it
-                g_hSettingsWnd = CreateWindowExW(
-                    0, SETTINGS_CLASS_NAME, L"Vimerate Settings", // No extended style, class, title
-                    WS_OVERLAPPEDWINDOW | WS_VISIBLE, // Standard window style, visible
-                    CW_USEDEFAULT, CW_USEDEFAULT, 450, 350, // Default pos, size
-                    hWnd, nullptr, GetModuleHandle(nullptr), nullptr // Parent, menu, instance, param
-                );
-                // Controls will be created in SettingsWndProc's WM_CREATE
-            } else { // If settings window exists, bring to foreground
-                SetForegroundWindow(g_hSettingsWnd);
-                ShowWindow(g_hSettingsWnd, SW_RESTORE); // Restore if minimized
-            }
+            if (g_hSettingsWnd) PostMessageW(g_hSettingsWnd, WM_APP_SHOW_SETTINGS, 0, 0); // Its thread shows it
         }
         else if (LOWORD(wParam) == IDM_EXIT) { // If 'Exit' clicked
             DestroyWindow(hWnd); // Close main window
@@ -328,63 +791,92 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         break;
 
     case WM_KEYDOWN: { // Key pressed message
-        if (g_state == HIDDEN) // Ignore if grid is hidden
+        if (g_grid.state == HIDDEN) // Ignore if grid is hidden
             break;
-        if (wParam == VK_ESCAPE) { // If Escape key
-            g_state = HIDDEN;      // Hide grid
-            ShowWindow(hWnd, SW_HIDE);
+        AllocScope scope(L"keystroke"); // Per-event allocation counter
+        wchar_t ch;
+        GridKey key = TranslateGridKey(wParam, lParam, ch);
+        GridResult r = g_grid.Key(key, ch); // Core/Grid.h decides; this carries it out
+        switch (r.step) {
+        case STEP_HIDE:
+            HideGrid(hWnd);
             break;
-        }
-        if (g_state == WAIT_CLICK) { // If waiting for click
-            if (wParam == '1') SimClick(MOUSEEVENTF_LEFTDOWN | MOUSEEVENTF_LEFTUP); // Left click
-            else if (wParam == '2') SimClick(MOUSEEVENTF_RIGHTDOWN | MOUSEEVENTF_RIGHTUP); // Right click
-            else if (wParam == '3') { // Double left click
-                SimClick(MOUSEEVENTF_LEFTDOWN | MOUSEEVENTF_LEFTUP);
-                SimClick(MOUSEEVENTF_LEFTDOWN | MOUSEEVENTF_LEFTUP);
-            }
-            g_state = HIDDEN;      // Hide grid after click
-            ShowWindow(hWnd, SW_HIDE);
+        case STEP_SCROLL: // Scroll at the cursor, keep the prompt open
+            SimClick(r.action);
+            RecordJumpAction(r.action);
+            LogEvent(TEL_ACTION, TACT_SCROLL, 0, 0);
+            break;
+        case STEP_NUDGE: { // Nudge by one pixel
+            POINT pt;
+            GetCursorPos(&pt);
+            SetCursorPos(pt.x + r.dx, pt.y + r.dy);
+            if (g_magnifier) CaptureLens();
+            LayoutAndDraw(hWnd, g_gridRect);
             break;
         }
-        if (wParam == VK_BACK) { // If Backspace key
-            if (!g_typed.empty()) { // If input exists, remove last char
-                g_typed.pop_back();
-                FilterCells();      // Re-filter cells
-                LayoutAndDraw(hWnd, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN)); // Redraw
-            } else { // If no input, hide grid
-                g_state = HIDDEN;
-                ShowWindow(hWnd, SW_HIDE);
+        case STEP_ZOOM:
+            g_lensZoom = std::max(MIN_LENS_ZOOM, std::min(g_lensZoom + r.dx, MAX_LENS_ZOOM));
+            CaptureLens(); // Zoom changes the captured square
+            LayoutAndDraw(hWnd, g_gridRect);
+            break;
+        case STEP_DRAG_START: // Pick the drop target with another label
+            KillTimer(hWnd, LENS_TIMER_ID); // Lens belongs to the prompt
+            GetCursorPos(&g_grid.dragFrom); // Drag starts where the cursor sits now
+            FilterCells();
+            LayoutAndDraw(hWnd, g_gridRect); // Redraw full grid
+            break;
+        case STEP_ACT: // Prompt action: replays repeat it
+            SimClick(r.action);
+            RecordJumpAction(r.action);
+            LogEvent(TEL_ACTION, TelemetryActionCode(r.action), 0, 0);
+            HideGrid(hWnd);
+            break;
+        case STEP_FILTER:
+        case STEP_LOOKUP: {
+            LogEvent(TEL_KEY, key == GKEY_BACKSPACE ? TKEY_BACKSPACE : TKEY_LABEL, (uint32_t)g_grid.typed.length(), 0);
+            FilterCells();
+            Cell* hit = nullptr; // Exact match; hidden labels (no target) don't match
+            for (auto c : g_filtered)
+                if (r.step == STEP_LOOKUP && c->lbl == g_grid.typed && c->rc.right > c->rc.left) { hit = c; break; }
+            if (!hit) { LayoutAndDraw(hWnd, g_gridRect); break; }
+            LogEvent(TEL_JUMP, (uint16_t)g_grid.typed.length(), g_grid.dragPending, 0);
+            GridResult sel = g_grid.Select(hit->pt);
+            if (sel.step == STEP_ACT) { // Drop target chosen: hide, then drag in one paced plan
+                LogEvent(TEL_ACTION, TACT_DRAG, 0, 0);
+                HideGrid(hWnd);
+                SimClick(sel.action);
+            } else {
+                MoveToAndPrompt(hit); // Move mouse and prompt
             }
             break;
         }
-        BYTE kbState[256];      // Keyboard state array
-        GetKeyboardState(kbState); // Get current keyboard state
-        wchar_t buf[2];         // Buffer for converted char
-        // Convert virtual key to Unicode char
-        int result = ToUnicode((UINT)wParam, HIWORD(lParam), kbState, buf, 1, 0);
-        // If char is valid and in pool or is '.'
-        if (result == 1 && (POOL.find(buf[0]) != std::wstring::npos || buf[0] == L'.')) {
-            g_typed += buf[0]; // Append char to typed string
-            FilterCells();     // Filter cells
-            if (g_typed.length() == 2 || g_typed.length() == 3) { // If 2 or 3 chars typed
-                for (auto c : g_filtered) { // Find exact match
-                    if (c->lbl == g_typed) {
-                        MoveToAndPrompt(c); // Move mouse and prompt
-                        break;
-                    }
-                }
-            } else { // Otherwise, just redraw grid
-                LayoutAndDraw(hWnd, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN));
-            }
+        default:
+            break;
         }
         break;
     }
 
-    case WM_DESTROY: // Window destroy message
-        if (g_hSettingsWnd) { // If settings window is open
-            DestroyWindow(g_hSettingsWnd); // Close settings window
-            g_hSettingsWnd = nullptr;
+    case WM_TIMER: // Magnifier refresh (the screen under the lens may be animating) or history write
+        if (wParam == LENS_TIMER_ID) {
+            if (g_grid.state != WAIT_CLICK || !g_magnifier) { KillTimer(hWnd, LENS_TIMER_ID); break; }
+            CaptureLens();
+            LayoutAndDraw(hWnd, g_gridRect); // A newer frame replaces an unrendered one, so this never queues up
+        } else if (wParam == HISTORY_TIMER_ID) { // Jumps went quiet: write the history once
+            KillTimer(hWnd, HISTORY_TIMER_ID);
+            if (g_historyDirty) SaveHistory();
         }
+        break;
+
+    case WM_APP_PRESENT: // Render thread finished a frame
+        if (wParam < 2) PresentBuffer(hWnd, g_buffers[wParam]);
+        break;
+
+    case WM_APP_SETTINGS: // Settings thread published a change; picked up between frames
+        ApplyPendingSettings();
+        break;
+
+    case WM_DESTROY: // Window destroy message
+        if (g_hSettingsWnd) PostMessageW(g_hSettingsWnd, WM_APP_CLOSE_SETTINGS, 0, 0); // Only its thread may destroy it
         PostQuitMessage(0); // Post quit message to exit app
         break;
 
@@ -399,7 +891,7 @@ void UpdatePoolSizeDisplay(HWND hSettingsWnd) {
     HWND hLabel = GetDlgItem(hSettingsWnd, IDC_POOL_SIZE_VALUE_LABEL); // Get label handle
     if (hLabel) { // If label exists
         std::wstringstream ss; // String stream for building text
-        ss << L"Currently using " << g_poolSize << L" characters."; // Build display string
+        ss << L"Currently using " << g_settingsView.poolSize << L" characters."; // Build display string
         SetWindowTextW(hLabel, ss.str().c_str()); // Set label text
     }
 }
@@ -412,10 +904,10 @@ void UpdateHotkeyDisplay(HWND hSettingsWnd) {
         std::vector<std::wstring> activeModifiers; // Vector for modifier names
 
         // Collect active modifiers (Win, Ctrl, Shift, Alt)
-        if (g_hotkeyMod1 == MOD_WIN || g_hotkeyMod2 == MOD_WIN) activeModifiers.push_back(L"Win");
-        if (g_hotkeyMod1 == MOD_CONTROL || g_hotkeyMod2 == MOD_CONTROL) activeModifiers.push_back(L"Ctrl");
-        if (g_hotkeyMod1 == MOD_SHIFT || g_hotkeyMod2 == MOD_SHIFT) activeModifiers.push_back(L"Shift");
-        if (g_hotkeyMod1 == MOD_ALT || g_hotkeyMod2 == MOD_ALT) activeModifiers.push_back(L"Alt");
+        if (g_settingsView.mod1 == MOD_WIN || g_settingsView.mod2 == MOD_WIN) activeModifiers.push_back(L"Win");
+        if (g_settingsView.mod1 == MOD_CONTROL || g_settingsView.mod2 == MOD_CONTROL) activeModifiers.push_back(L"Ctrl");
+        if (g_settingsView.mod1 == MOD_SHIFT || g_settingsView.mod2 == MOD_SHIFT) activeModifiers.push_back(L"Shift");
+        if (g_settingsView.mod1 == MOD_ALT || g_settingsView.mod2 == MOD_ALT) activeModifiers.push_back(L"Alt");
 
         // Sort and remove duplicate modifiers for consistent display
         std::sort(activeModifiers.begin(), activeModifiers.end());
@@ -427,20 +919,20 @@ void UpdateHotkeyDisplay(HWND hSettingsWnd) {
             if (i < activeModifiers.size() - 1) { hotkeyString += L" + "; } // Add '+' separator
         }
 
-        if (g_hotkeyVKey != 0) { // If a virtual key is set
+        if (g_settingsView.vkey != 0) { // If a virtual key is set
             if (!hotkeyString.empty()) { hotkeyString += L" + "; } // Add '+' if modifiers exist
 
-            UINT scanCode = MapVirtualKeyW(g_hotkeyVKey, 0); // Convert VKey to scan code
+            UINT scanCode = MapVirtualKeyW(g_settingsView.vkey, 0); // Convert VKey to scan code
             wchar_t keyName[256]; // Buffer for key name
             // Get human-readable key name (e.g., "Z", "F1")
             if (GetKeyNameTextW(scanCode << 16, keyName, sizeof(keyName) / sizeof(keyName[0]))) {
                 hotkeyString += keyName; // Append key name
             } else { // Fallback for specific character keys
-                if (g_hotkeyVKey >= 'A' && g_hotkeyVKey <= 'Z' || g_hotkeyVKey >= '0' && g_hotkeyVKey <= '9') {
-                    hotkeyString += (wchar_t)g_hotkeyVKey; // Append character directly
+                if (g_settingsView.vkey >= 'A' && g_settingsView.vkey <= 'Z' || g_settingsView.vkey >= '0' && g_settingsView.vkey <= '9') {
+                    hotkeyString += (wchar_t)g_settingsView.vkey; // Append character directly
                 } else { // Fallback for other VKey codes
                     std::wstringstream ss;
-                    ss << L"VKey_" << g_hotkeyVKey;
+                    ss << L"VKey_" << g_settingsView.vkey;
                     hotkeyString += ss.str();
                 }
             }
@@ -476,17 +968,17 @@ void PopulateHotkeyDropdowns(HWND hSettingsWnd) {
         SendMessageW(hMod2Combo, CB_SETITEMDATA, index, (LPARAM)mod.value);
     }
 
-    // Select current g_hotkeyMod1 in first combo box
+    // Select current g_settingsView.mod1 in first combo box
     int selectedIndex = 0;
     for (int i = 0; i < _countof(modifiers); ++i) {
-        if (modifiers[i].value == g_hotkeyMod1) { selectedIndex = i; break; }
+        if (modifiers[i].value == g_settingsView.mod1) { selectedIndex = i; break; }
     }
     SendMessageW(hMod1Combo, CB_SETCURSEL, selectedIndex, 0);
 
-    // Select current g_hotkeyMod2 in second combo box
+    // Select current g_settingsView.mod2 in second combo box
     selectedIndex = 0;
     for (int i = 0; i < _countof(modifiers); ++i) {
-        if (modifiers[i].value == g_hotkeyMod2) { selectedIndex = i; break; }
+        if (modifiers[i].value == g_settingsView.mod2) { selectedIndex = i; break; }
     }
     SendMessageW(hMod2Combo, CB_SETCURSEL, selectedIndex, 0);
 
@@ -525,57 +1017,36 @@ void PopulateHotkeyDropdowns(HWND hSettingsWnd) {
         SendMessageW(hVKeyCombo, CB_SETITEMDATA, index, (LPARAM)vk.second);
     }
 
-    // Select current g_hotkeyVKey in the combo box
+    // Select current g_settingsView.vkey in the combo box
     selectedIndex = 0;
     for (size_t i = 0; i < vkeys_data.size(); ++i) {
-        if (vkeys_data[i].second == g_hotkeyVKey) { selectedIndex = i; break; }
+        if (vkeys_data[i].second == g_settingsView.vkey) { selectedIndex = i; break; }
     }
     SendMessageW(hVKeyCombo, CB_SETCURSEL, selectedIndex, 0);
 }
 
 // Function to reset all settings to their default values
 void ResetToDefaults(HWND hSettingsWnd) {
-    g_cellColor = DEFAULT_CELL_COLOR; // Reset cell color
-    g_poolSize = DEFAULT_POOL_SIZE;     // Reset pool size
-
-    // Store current hotkey for potential rollback
-    UINT oldMod1 = g_hotkeyMod1; UINT oldMod2 = g_hotkeyMod2; UINT oldVKey = g_hotkeyVKey;
+    g_settingsView.cellColor = DEFAULT_CELL_COLOR; // Reset cell color
+    g_settingsView.poolSize = DEFAULT_POOL_SIZE;     // Reset pool size
 
-    // Set hotkey to default values
-    g_hotkeyMod1 = DEFAULT_HOTKEY_MOD1;
-    g_hotkeyMod2 = DEFAULT_HOTKEY_MOD2;
-    g_hotkeyVKey = DEFAULT_HOTKEY_VKEY;
-
-    UnregisterAppHotkey(); // Unregister current hotkey
-    if (!RegisterAppHotkey()) { // Try to register default hotkey
-        // If default fails, revert to previous hotkey
-        g_hotkeyMod1 = oldMod1; g_hotkeyMod2 = oldMod2; g_hotkeyVKey = oldVKey;
-        RegisterAppHotkey(); // Re-register the working hotkey
-        MessageBoxW(hSettingsWnd, L"Failed to register the default hotkey. Reverted to previous hotkey.", L"Hotkey Reset Warning", MB_OK | MB_ICONWARNING);
-    }
+    // Set hotkey to default values (the overlay reverts it if it can't be registered)
+    g_settingsView.mod1 = DEFAULT_HOTKEY_MOD1;
+    g_settingsView.mod2 = DEFAULT_HOTKEY_MOD2;
+    g_settingsView.vkey = DEFAULT_HOTKEY_VKEY;
 
     // Update settings window controls
     InvalidateRect(hSettingsWnd, nullptr, TRUE); // Redraw color preview
     UpdateWindow(hSettingsWnd); // Force immediate redraw
-    SendMessage(GetDlgItem(hSettingsWnd, IDC_POOL_SIZE_SLIDER), TBM_SETPOS, (WPARAM)TRUE, (LPARAM)g_poolSize); // Set slider position
+    SendMessage(GetDlgItem(hSettingsWnd, IDC_POOL_SIZE_SLIDER), TBM_SETPOS, (WPARAM)TRUE, (LPARAM)g_settingsView.poolSize); // Set slider position
     UpdatePoolSizeDisplay(hSettingsWnd); // Update pool size label
 
     PopulateHotkeyDropdowns(hSettingsWnd); // Repopulate and select hotkey dropdowns
     UpdateHotkeyDisplay(hSettingsWnd); // Update hotkey display label
 
-    // Update main grid
-    GenerateCells(); // Regenerate cells based on new settings
-    FilterCells(); // Re-filter cells
-    if (g_hGridWnd) { // If main window exists
-        LayoutAndDraw(g_hGridWnd, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN)); // Redraw grid
-        InvalidateRect(g_hGridWnd, nullptr, TRUE);
-        UpdateWindow(g_hGridWnd);
-    }
-
-    SaveSettings(); // Save updated (or reverted) settings
+    PublishSettings(); // Overlay regenerates, re-registers and saves
 }
 
-
 // Window Procedure for the Settings Window
 LRESULT CALLBACK SettingsWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
     switch (message) {
@@ -634,7 +1105,7 @@ LRESULT CALLBACK SettingsWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM
 
             // Set slider range (min to max pool size)
             SendMessage(hSlider, TBM_SETRANGE, (WPARAM)TRUE, (LPARAM)MAKELONG(MIN_POOL_SIZE, (int)POOL.length()));
-            SendMessage(hSlider, TBM_SETPOS, (WPARAM)TRUE, (LPARAM)g_poolSize); // Set current position
+            SendMessage(hSlider, TBM_SETPOS, (WPARAM)TRUE, (LPARAM)g_settingsView.poolSize); // Set current position
             SendMessage(hSlider, TBM_SETPAGESIZE, 0, 1); // Page increment
             SendMessage(hSlider, TBM_SETTICFREQ, 1, 0); // Tick frequency
 
@@ -734,7 +1205,7 @@ LRESULT CALLBACK SettingsWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM
             RECT colorPreviewRect = {previewX, previewY, previewX + previewWidth, previewY + previewHeight};
 
             // Create solid brush with current cell color
-            HBRUSH hBrush = CreateSolidBrush(RGB(g_cellColor.GetR(), g_cellColor.GetG(), g_cellColor.GetB()));
+            HBRUSH hBrush = CreateSolidBrush(RGB(g_settingsView.cellColor.GetR(), g_settingsView.cellColor.GetG(), g_settingsView.cellColor.GetB()));
             FillRect(hdc, &colorPreviewRect, hBrush); // Fill rectangle
             DeleteObject(hBrush); // Delete brush to prevent leaks
 
@@ -754,20 +1225,15 @@ LRESULT CALLBACK SettingsWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM
                 cc.Flags = CC_RGBINIT | CC_FULLOPEN; // Init with RGB, full dialog
 
                 // Set initial color for dialog
-                cc.rgbResult = RGB(g_cellColor.GetR(), g_cellColor.GetG(), g_cellColor.GetB());
+                cc.rgbResult = RGB(g_settingsView.cellColor.GetR(), g_settingsView.cellColor.GetG(), g_settingsView.cellColor.GetB());
 
                 if (ChooseColor(&cc)) { // If user selected color
                     // Update global cell color (preserve alpha)
-                    g_cellColor = Gdiplus::Color(g_cellColor.GetA(), GetRValue(cc.rgbResult), GetGValue(cc.rgbResult), GetBValue(cc.rgbResult));
-
-                    if (g_hGridWnd) { // If main grid window exists
-                        InvalidateRect(g_hGridWnd, nullptr, TRUE); // Redraw grid
-                        UpdateWindow(g_hGridWnd); // Force redraw
-                    }
+                    g_settingsView.cellColor = Gdiplus::Color(g_settingsView.cellColor.GetA(), GetRValue(cc.rgbResult), GetGValue(cc.rgbResult), GetBValue(cc.rgbResult));
 
                     InvalidateRect(hWnd, nullptr, TRUE); // Redraw settings window
                     UpdateWindow(hWnd); // Force redraw
-                    SaveSettings(); // Save new settings
+                    PublishSettings(); // Overlay redraws and saves
                 }
             } else if (LOWORD(wParam) == IDC_RESET_BUTTON) { // Reset button clicked
                 ResetToDefaults(hWnd); // Call reset function
@@ -785,36 +1251,12 @@ LRESULT CALLBACK SettingsWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM
                 UINT newVKey = (UINT)SendMessage(GetDlgItem(hWnd, IDC_HOTKEY_VKEY_COMBO), CB_GETITEMDATA, selVKeyIndex, 0);
 
                 // Check if hotkey parts actually changed
-                if (newMod1 != g_hotkeyMod1 || newMod2 != g_hotkeyMod2 || newVKey != g_hotkeyVKey) {
-                    // Store current hotkey for rollback
-                    UINT oldMod1 = g_hotkeyMod1;
-                    UINT oldMod2 = g_hotkeyMod2;
-                    UINT oldVKey = g_hotkeyVKey;
-
-                    // Update global hotkey variables
-                    g_hotkeyMod1 = newMod1;
-                    g_hotkeyMod2 = newMod2;
-                    g_hotkeyVKey = newVKey;
-
-                    UnregisterAppHotkey(); // Unregister existing hotkey
-
-                    // Try to register new hotkey
-                    if (!RegisterAppHotkey()) {
-                        // If new hotkey fails, revert to old
-                        g_hotkeyMod1 = oldMod1;
-                        g_hotkeyMod2 = oldMod2;
-                        g_hotkeyVKey = oldVKey;
-
-                        RegisterAppHotkey(); // Re-register working hotkey
-                        // Update UI to show reverted hotkey
-                        PopulateHotkeyDropdowns(hWnd); // Re-populate selections
-                        UpdateHotkeyDisplay(hWnd); // Update display text
-                        // Don't save: hotkey failed to register
-                    } else {
-                        // Hotkey registration succeeded
-                        UpdateHotkeyDisplay(hWnd); // Update display text
-                        SaveSettings(); // Save new hotkey
-                    }
+                if (newMod1 != g_settingsView.mod1 || newMod2 != g_settingsView.mod2 || newVKey != g_settingsView.vkey) {
+                    g_settingsView.mod1 = newMod1;
+                    g_settingsView.mod2 = newMod2;
+                    g_settingsView.vkey = newVKey;
+                    UpdateHotkeyDisplay(hWnd); // Update display text
+                    PublishSettings(); // Hotkeys belong to the overlay thread; a failure comes back as a notice
                 }
             }
             break;
@@ -822,29 +1264,42 @@ LRESULT CALLBACK SettingsWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM
         case WM_HSCROLL: // Scroll bar (slider) message
             if ((HWND)lParam == GetDlgItem(hWnd, IDC_POOL_SIZE_SLIDER)) { // If it's our slider
                 int newPoolSize = (int)SendMessage((HWND)lParam, TBM_GETPOS, 0, 0); // Get slider position
-                if (newPoolSize != g_poolSize) { // If pool size changed
-                    g_poolSize = newPoolSize; // Update global pool size
+                if (newPoolSize != g_settingsView.poolSize) { // If pool size changed
+                    g_settingsView.poolSize = newPoolSize; // Update global pool size
 
                     UpdatePoolSizeDisplay(hWnd); // Update display label
-
-                    GenerateCells(); // Re-generate grid cells
-                    FilterCells(); // Re-filter cells
-                    if (g_hGridWnd) { // If main grid window exists
-                        LayoutAndDraw(g_hGridWnd, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN)); // Redraw grid
-                        InvalidateRect(g_hGridWnd, nullptr, TRUE); // Invalidate area
-                        UpdateWindow(g_hGridWnd); // Force redraw
-                    }
-                    SaveSettings(); // Save new settings
+                    PublishSettings(); // A fast drag collapses into whatever the overlay sees next
                 }
             }
             break;
 
+        case WM_APP_SHOW_SETTINGS: // Tray menu asked for the window
+            ShowWindow(hWnd, IsIconic(hWnd) ? SW_RESTORE : SW_SHOW); // Restore if minimized
+            SetForegroundWindow(hWnd);
+            break;
+
+        case WM_APP_HOTKEY_NOTICE: // Overlay could not register the hotkey
+            g_settingsView.mod1 = (UINT)(lParam & 0xFF); // What the overlay actually has
+            g_settingsView.mod2 = (UINT)((lParam >> 8) & 0xFF);
+            g_settingsView.vkey = (UINT)((lParam >> 16) & 0xFF);
+            PopulateHotkeyDropdowns(hWnd); // Re-populate selections
+            UpdateHotkeyDisplay(hWnd); // Update display text
+            MessageBoxW(IsWindowVisible(hWnd) ? hWnd : nullptr,
+                        wParam ? L"Failed to register hotkey. It might be in use by another application. Reverted to the previous hotkey."
+                               : L"Failed to register hotkey. It might be in use by another application.",
+                        L"Hotkey Warning", MB_OK | MB_ICONWARNING | MB_SETFOREGROUND);
+            break;
+
+        case WM_APP_CLOSE_SETTINGS: // Overlay is exiting
+            DestroyWindow(hWnd);
+            break;
+
         case WM_CLOSE: // Window close message
             ShowWindow(hWnd, SW_HIDE); // Hide window instead of destroying
             return 0; // Handled message, prevent default destroy
 
         case WM_DESTROY: // Window destroy message
-            g_hSettingsWnd = nullptr; // Clear global handle
+            PostQuitMessage(0); // Ends the settings thread's message loop
             break;
 
         default: // Default message handling
@@ -853,6 +1308,91 @@ LRESULT CALLBACK SettingsWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM
     return 0; // Message handled
 }
 
+// --- Settings Thread ---
+
+// Settings thread: create the window hidden, report it, then pump its messages
+static DWORD WINAPI SettingsThreadMain(LPVOID param) {
+    g_hSettingsWnd = CreateWindowExW(
+        0, SETTINGS_CLASS_NAME, L"Vimerate Settings", // No extended style, class, title
+        WS_OVERLAPPEDWINDOW, // Standard window style, shown on request
+        CW_USEDEFAULT, CW_USEDEFAULT, 450, 350, // Default pos, size
+        nullptr, nullptr, GetModuleHandle(nullptr), nullptr // No owner: an owner on the overlay thread would share its input queue
+    );
+    SetEvent((HANDLE)param); // g_hSettingsWnd is valid (or null) from here on
+    if (!g_hSettingsWnd) return 0;
+    MSG msg;
+    while (GetMessageW(&msg, nullptr, 0, 0)) {
+        TranslateMessage(&msg);
+        DispatchMessageW(&msg);
+    }
+    return 0;
+}
+
+// Start the settings thread with a copy of the loaded settings; returns once the window exists
+void StartSettingsThread() {
+    g_settingsView.cellColor = g_cellColor; // The view is the settings thread's from here on
+    g_settingsView.poolSize = g_poolSize;
+    g_settingsView.mod1 = g_hotkeyMod1;
+    g_settingsView.mod2 = g_hotkeyMod2;
+    g_settingsView.vkey = g_hotkeyVKey;
+    HANDLE ready = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!ready) return;
+    g_settingsThread = CreateThread(nullptr, 0, SettingsThreadMain, ready, 0, nullptr);
+    if (g_settingsThread) WaitForSingleObject(ready, INFINITE);
+    CloseHandle(ready);
+}
+
+// Join the settings thread (WM_APP_CLOSE_SETTINGS was posted) and drop an unapplied snapshot
+void StopSettingsThread() {
+    if (g_settingsThread) {
+        // A modal dialog closes with its owner; the timeout only guards against a stuck system dialog
+        WaitForSingleObject(g_settingsThread, 2000);
+        CloseHandle(g_settingsThread);
+        g_settingsThread = nullptr;
+    }
+    g_hSettingsWnd = nullptr;
+    delete (SettingsSnapshot*)InterlockedExchangePointer(&g_pendingSettings, nullptr);
+}
+
+// Settings thread: hand a copy of g_settingsView to the overlay. Only the newest unapplied
+// copy is kept, so a dragged slider costs the overlay one apply per message it gets to.
+void PublishSettings() {
+    SettingsSnapshot* older = (SettingsSnapshot*)InterlockedExchangePointer(
+        &g_pendingSettings, new SettingsSnapshot(g_settingsView));
+    delete older; // Superseded before the overlay got to it
+    PostMessageW(g_hGridWnd, WM_APP_SETTINGS, 0, 0);
+}
+
+// Overlay thread: apply the newest published settings, between frames. A hotkey that can't be
+// registered is reverted, and the settings thread is told so it can resync and warn.
+void ApplyPendingSettings() {
+    SettingsSnapshot* s = (SettingsSnapshot*)InterlockedExchangePointer(&g_pendingSettings, nullptr);
+    if (!s) return; // An earlier message already took it
+
+    g_cellColor = s->cellColor;
+    if (s->poolSize != g_poolSize) {
+        g_poolSize = s->poolSize;
+        InterlockedExchange(&g_pipePoolSize, g_poolSize); // Pipe commands use the new size from their next batch
+        g_gridInWindow = g_gridInWindow && g_grid.state != HIDDEN; // The next activation fits its own area
+        GenerateCells(g_gridInWindow ? FittingPool(g_gridRect, g_poolSize, g_fontScale) : g_poolSize); // Re-generate grid cells
+        FilterCells(); // Re-filter cells
+    }
+    if (s->mod1 != g_hotkeyMod1 || s->mod2 != g_hotkeyMod2 || s->vkey != g_hotkeyVKey) {
+        UINT oldMod1 = g_hotkeyMod1, oldMod2 = g_hotkeyMod2, oldVKey = g_hotkeyVKey; // For rollback
+        g_hotkeyMod1 = s->mod1; g_hotkeyMod2 = s->mod2; g_hotkeyVKey = s->vkey;
+        UnregisterAppHotkey();
+        if (!RegisterAppHotkey()) { // Keep the working hotkey
+            g_hotkeyMod1 = oldMod1; g_hotkeyMod2 = oldMod2; g_hotkeyVKey = oldVKey;
+            RegisterAppHotkey();
+            if (g_hSettingsWnd) PostMessageW(g_hSettingsWnd, WM_APP_HOTKEY_NOTICE, TRUE, PackHotkey());
+        }
+    }
+    delete s;
+
+    if (g_grid.state != HIDDEN) LayoutAndDraw(g_hGridWnd, g_gridRect); // Visible grid picks up the change
+    SaveSettings(); // Save new (or reverted) settings
+}
+
 // --- Helper functions for color conversion and settings persistence ---
 
 // Converts hex string (RRGGBB) to Gdiplus::Color
@@ -917,6 +1457,23 @@ void LoadSettings() {
     g_hotkeyMod1 = (UINT)GetPrivateProfileIntW(INI_SECTION, INI_KEY_HOTKEY_MOD1, DEFAULT_HOTKEY_MOD1, g_iniFilePath.c_str());
     g_hotkeyMod2 = (UINT)GetPrivateProfileIntW(INI_SECTION, INI_KEY_HOTKEY_MOD2, DEFAULT_HOTKEY_MOD2, g_iniFilePath.c_str());
     g_hotkeyVKey = (UINT)GetPrivateProfileIntW(INI_SECTION, INI_KEY_HOTKEY_VKEY, DEFAULT_HOTKEY_VKEY, g_iniFilePath.c_str());
+    g_hotkeyWindowVKey = (UINT)GetPrivateProfileIntW(INI_SECTION, INI_KEY_WINDOW_VKEY, DEFAULT_WINDOW_VKEY, g_iniFilePath.c_str());
+    g_hotkeyRepeatVKey = (UINT)GetPrivateProfileIntW(INI_SECTION, INI_KEY_REPEAT_VKEY, DEFAULT_REPEAT_VKEY, g_iniFilePath.c_str());
+
+    // Load diagnostics switches (hand-edited only, never written back)
+    g_diagnostics = GetPrivateProfileIntW(INI_SECTION, INI_KEY_DIAGNOSTICS, 0, g_iniFilePath.c_str()) != 0;
+    g_dumpFrames = GetPrivateProfileIntW(INI_SECTION, INI_KEY_DUMP_FRAMES, 0, g_iniFilePath.c_str()) != 0;
+    g_commandPipe = GetPrivateProfileIntW(INI_SECTION, INI_KEY_COMMAND_PIPE, 0, g_iniFilePath.c_str()) != 0;
+    g_smartTargets = GetPrivateProfileIntW(INI_SECTION, INI_KEY_SMART_TARGETS, 0, g_iniFilePath.c_str()) != 0;
+    g_adaptiveContrast = GetPrivateProfileIntW(INI_SECTION, INI_KEY_ADAPTIVE_CONTRAST, 0, g_iniFilePath.c_str()) != 0;
+    g_foveated = GetPrivateProfileIntW(INI_SECTION, INI_KEY_FOVEATED_LAYOUT, 0, g_iniFilePath.c_str()) != 0;
+    g_magnifier = GetPrivateProfileIntW(INI_SECTION, INI_KEY_MAGNIFIER, 0, g_iniFilePath.c_str()) != 0;
+    g_lensZoom = GetPrivateProfileIntW(INI_SECTION, INI_KEY_MAGNIFIER_ZOOM, DEFAULT_LENS_ZOOM, g_iniFilePath.c_str());
+    g_lensZoom = std::max(MIN_LENS_ZOOM, std::min(g_lensZoom, MAX_LENS_ZOOM));
+    g_lensBilinear = GetPrivateProfileIntW(INI_SECTION, INI_KEY_MAGNIFIER_BILINEAR, 0, g_iniFilePath.c_str()) != 0;
+    g_frameBudgetMs = std::max(0, (int)GetPrivateProfileIntW(INI_SECTION, INI_KEY_FRAME_BUDGET, DEFAULT_FRAME_BUDGET_MS, g_iniFilePath.c_str()));
+    g_telemetryEnabled = GetPrivateProfileIntW(INI_SECTION, INI_KEY_TELEMETRY, 0, g_iniFilePath.c_str()) != 0;
+    g_historyHotkeys = GetPrivateProfileIntW(INI_SECTION, INI_KEY_HISTORY_HOTKEYS, 0, g_iniFilePath.c_str()) != 0;
 }
 
 // Saves current settings to the INI file
@@ -949,49 +1506,33 @@ void SaveSettings() {
 }
 
 // Generate cells with double columns (normal and dotted)
-void GenerateCells() {
+void GenerateCells(int pool) {
     g_cells.clear(); // Clear existing cells
-    int currentPoolUsedSize = g_poolSize; // Use current pool size
-
-    for (int row = 0; row < currentPoolUsedSize; ++row) { // Iterate for first char
-        wchar_t firstChar = POOL[row]; // Get first char
-        for (int col = 0; col < currentPoolUsedSize; ++col) { // Iterate for second char
-            wchar_t secondChar = POOL[col]; // Get second char
-
-            // Create normal two-character cell
-            Cell leftCell;
-            leftCell.lbl = std::wstring() + firstChar + secondChar;
-            g_cells.push_back(leftCell);
-
-            // Create dotted three-character cell
-            Cell rightCell;
-            rightCell.lbl = std::wstring() + firstChar + L'.' + secondChar;
-            g_cells.push_back(rightCell);
-        }
+    g_gridPool = pool; // Layout, targets and rendering follow the cells
+    size_t count = GridCellCount(pool); // Plain and dotted label for every pair of characters
+    g_cells.reserve(count); // One allocation for the grid
+    g_filtered.reserve(g_cells.capacity()); // Filtering never needs to grow later
+    g_contrastDirty = true; // New cells start with default colors
+
+    wchar_t lbl[4];
+    for (size_t i = 0; i < count; ++i) { // Core/Grid.h order: row by row, each label then its dotted twin
+        int n = CellLabel(i, pool, lbl);
+        g_cells.emplace_back();
+        g_cells.back().lbl.assign(lbl, n); // Short labels stay in the string's inline buffer
     }
 }
 
-// Filter cells based on user's typed input
+// Filter cells based on user's typed input, while typing and at the click prompt alike
 void FilterCells() {
-    g_filtered.clear(); // Clear filtered list
-    if (g_state == SHOW_ALL || g_typed.empty()) { // If showing all or no input
-        for (auto& c : g_cells)
-            g_filtered.push_back(&c); // Add all cells
-    } else { // Filter based on input
-        for (auto& c : g_cells) {
-            if (c.lbl.rfind(g_typed, 0) == 0) // If label starts with typed string
-                g_filtered.push_back(&c); // Add to filtered list
-        }
-    }
+    FilterByPrefix(g_cells, g_grid.typed, g_filtered); // Core/Grid.h; g_filtered never grows past its reserve
 }
 
-// Layout and draw grid cells on overlay window
-void LayoutAndDraw(HWND hWnd, int W, int H) {
-    using namespace Gdiplus; // Use GDI+ namespace
-
-    HDC screenDC = GetDC(nullptr); // Get screen device context
-    HDC memDC = CreateCompatibleDC(screenDC); // Create memory device context
+// Create the surface, or keep the existing one if the size is unchanged
+bool EnsureSurface(Surface& sf, int W, int H) {
+    if (sf.bmp && sf.w == W && sf.h == H) return true; // Reuse: no allocation per frame
+    ReleaseSurface(sf);
 
+    HDC screenDC = GetDC(nullptr); // Screen DC for compatibility
     BITMAPINFO bmi = {}; // Bitmap info structure
     bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER); // Structure size
     bmi.bmiHeader.biWidth = W; // Bitmap width
@@ -1000,146 +1541,1478 @@ void LayoutAndDraw(HWND hWnd, int W, int H) {
     bmi.bmiHeader.biBitCount = 32; // 32 bits per pixel
     bmi.bmiHeader.biCompression = BI_RGB; // RGB compression
 
-    void* bits = nullptr; // Pointer to bitmap bits
-    HBITMAP hBmp = CreateDIBSection(screenDC, &bmi, DIB_RGB_COLORS, &bits, nullptr, 0); // Create DIB section
-    HBITMAP oldBmp = (HBITMAP)SelectObject(memDC, hBmp); // Select bitmap into memory DC
-
-    Graphics mg(memDC); // GDI+ graphics object
-    mg.SetSmoothingMode(SmoothingModeAntiAlias); // Enable anti-aliasing
-    mg.Clear(Color(0, 0, 0, 0)); // Clear with transparent black
-
-    SolidBrush cellBrush(g_cellColor); // Brush for cell background (global color)
-    Font font(L"Arial", 11, FontStyleBold); // Font for cell labels
-    SolidBrush textBrush(Color(255, 0, 0, 0)); // Brush for text (black)
-
-    StringFormat sf; // String format for text alignment
-    sf.SetAlignment(StringAlignmentCenter); // Center horizontally
-    sf.SetLineAlignment(StringAlignmentCenter); // Center vertically
-    sf.SetFormatFlags(StringFormatFlagsNoWrap); // No text wrapping
-
-    int rows = g_poolSize; // Number of rows in grid
-    int cols = g_poolSize * 2; // Double columns (normal + dotted)
-
-    float cellW = (float)W / cols; // Cell width
-    float cellH = (float)H / rows; // Cell height
-
-    // Recalculate cell positions based on g_poolSize
-    for (auto& c : g_cells) { // Iterate through all cells
-        std::wstring lbl = c.lbl; // Cell label
-        int firstCharIdx = (lbl.length() >= 1) ? (int)POOL.find(lbl[0]) : std::wstring::npos; // Index of first char
-
-        if (lbl.length() == 2 && firstCharIdx != std::wstring::npos) { // Normal two-char label
-            int secondCharIdx = (lbl.length() >= 2) ? (int)POOL.find(lbl[1]) : std::wstring::npos; // Index of second char
-            if (secondCharIdx != std::wstring::npos && firstCharIdx < g_poolSize && secondCharIdx < g_poolSize) {
-                 c.rc = {
-                     LONG(secondCharIdx * cellW), // X position
-                     LONG(firstCharIdx * cellH), // Y position
-                     LONG((secondCharIdx + 1) * cellW), // Right edge
-                     LONG((firstCharIdx + 1) * cellH) // Bottom edge
-                 };
-            } else { c.rc = { -100, -100, -90, -90 }; } // Mark invalid
+    sf.dc = CreateCompatibleDC(screenDC); // Memory DC that keeps the bitmap selected
+    sf.bmp = CreateDIBSection(screenDC, &bmi, DIB_RGB_COLORS, &sf.bits, nullptr, 0); // Create DIB section
+    ReleaseDC(nullptr, screenDC);
+    if (!sf.dc || !sf.bmp) { ReleaseSurface(sf); return false; }
+    sf.oldBmp = (HBITMAP)SelectObject(sf.dc, sf.bmp); // Select once for the surface's lifetime
+    sf.w = W;
+    sf.h = H;
+    return true;
+}
+
+// Free the surface's bitmap and DC
+void ReleaseSurface(Surface& sf) {
+    if (sf.dc && sf.oldBmp) SelectObject(sf.dc, sf.oldBmp); // Restore original bitmap
+    if (sf.bmp) DeleteObject(sf.bmp);
+    if (sf.dc) DeleteDC(sf.dc);
+    sf = Surface();
+}
+
+// Primary screen as a grid area
+RECT ScreenRect() {
+    return { 0, 0, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN) };
+}
+
+// Foreground window's rectangle, clipped to the virtual desktop, and in 'pool' the largest pool size
+// up to g_poolSize whose label boxes fit its cells. 'pool' is 0 if there is no usable window
+// (desktop, minimized, or too small even for MIN_POOL_SIZE labels).
+RECT ForegroundWindowRect(int& pool) {
+    pool = 0;
+    HWND fg = GetForegroundWindow();
+    if (fg) fg = GetAncestor(fg, GA_ROOT); // Top-level window, not a child control
+    RECT rc = {};
+    if (!fg || IsIconic(fg) || !GetWindowRect(fg, &rc)) return rc;
+
+    int vx = GetSystemMetrics(SM_XVIRTUALSCREEN), vy = GetSystemMetrics(SM_YVIRTUALSCREEN); // Virtual desktop
+    rc.left = std::max(rc.left, (LONG)vx);
+    rc.top = std::max(rc.top, (LONG)vy);
+    rc.right = std::min(rc.right, (LONG)(vx + GetSystemMetrics(SM_CXVIRTUALSCREEN)));
+    rc.bottom = std::min(rc.bottom, (LONG)(vy + GetSystemMetrics(SM_CYVIRTUALSCREEN)));
+    pool = FittingPool(rc, g_poolSize, g_fontScale); // Same scale as the atlas labels
+    return rc;
+}
+
+// Compute cell rectangles for a grid covering 'area' (pure geometry, no drawing)
+void LayoutCells(const RECT& area) {
+    LayoutGrid(g_cells, area, g_gridPool, g_foveated ? &g_focus : nullptr, g_rowEdges, g_colEdges); // Core/Grid.h
+    if (g_smartTargets && !g_targets.empty()) // Labels follow the content
+        PlaceTargets(g_targets, area, g_gridPool, g_rowEdges, g_colEdges, g_cells, g_analysis);
+    if (g_adaptiveContrast && g_contrastDirty && EqualRect(&area, &g_analysis.area)) ApplyCellContrast();
+}
+
+// --- Screen analysis ---
+// The pixel kernels (Core/Kernels.h) and the target detector (Core/Targets.h) work on plain 32bpp
+// BGRA buffers, so live captures and image fixtures share one path.
+
+// Pick each visible cell's box and text color from the mean and spread of the luminance behind it.
+// The box keeps the user's hue but moves away from the background's brightness, turns more opaque
+// on busy backgrounds, and the text is black or white, whichever contrasts with the result.
+void ApplyCellContrast() {
+    const ScreenAnalysis& s = g_analysis;
+    g_contrastDirty = false;
+    if (s.lw <= 0 || s.lh <= 0) return; // Nothing captured yet
+    BYTE r = g_cellColor.GetR(), g = g_cellColor.GetG(), b = g_cellColor.GetB(), a = g_cellColor.GetA();
+    int boxLuma = (r * 77 + g * 150 + b * 29) >> 8;
+
+    for (auto& c : g_cells) {
+        c.box = c.text = 0; // Defaults unless the cell is on the analyzed plane
+        if (c.rc.right <= c.rc.left) continue;
+        int x0 = std::max(0, (int)(c.rc.left - s.area.left) / TARGET_SCALE);
+        int y0 = std::max(0, (int)(c.rc.top - s.area.top) / TARGET_SCALE);
+        int x1 = std::min(s.lw, (int)(c.rc.right - s.area.left) / TARGET_SCALE);
+        int y1 = std::min(s.lh, (int)(c.rc.bottom - s.area.top) / TARGET_SCALE);
+        if (x1 <= x0 || y1 <= y0) continue;
+
+        uint64_t sum, sumSq;
+        LumaStats(s.luma.data(), s.lw, x0, y0, x1, y1, sum, sumSq);
+        double n = (double)(x1 - x0) * (y1 - y0);
+        double mean = sum / n;
+        double sd = std::sqrt(std::max(0.0, sumSq / n - mean * mean));
+
+        // Lighten or darken the box until it differs from the background by at least 100 levels
+        int br = r, bg = g, bb = b;
+        if (mean >= 128 && boxLuma > mean - 100) { // Light background: darken
+            double k = std::max(0.0, (mean - 100) / std::max(1, boxLuma));
+            br = (int)(r * k); bg = (int)(g * k); bb = (int)(b * k);
+        } else if (mean < 128 && boxLuma < mean + 100) { // Dark background: lighten
+            double t = std::min(1.0, (mean + 100 - boxLuma) / std::max(1, 255 - boxLuma));
+            br = (int)(r + (255 - r) * t); bg = (int)(g + (255 - g) * t); bb = (int)(b + (255 - b) * t);
+        }
+        int alpha = std::min(255, (int)(a + sd * 2)); // Busy background: hide more of it
+        double shown = (br * 77 + bg * 150 + bb * 29) / 256.0; // Box over the mean background
+        double seen = (shown * alpha + mean * (255 - alpha)) / 255.0;
+        c.box = Gdiplus::Color::MakeARGB((BYTE)alpha, (BYTE)br, (BYTE)bg, (BYTE)bb);
+        c.text = seen >= 128 ? Gdiplus::Color::MakeARGB(255, 0, 0, 0) : Gdiplus::Color::MakeARGB(255, 255, 255, 255);
+    }
+}
+
+// Capture the screen under 'area', build its luma plane and detect targets if enabled.
+// Called before the overlay is shown.
+void CaptureScreen(const RECT& area) {
+    g_targets.clear();
+    int w = area.right - area.left, h = area.bottom - area.top;
+    if (g_capture.w < w || g_capture.h < h) // Grow only, like the back buffers
+        EnsureSurface(g_capture, std::max(g_capture.w, w), std::max(g_capture.h, h));
+    if (!g_capture.bmp) return; // No capture: plain lattice
+
+    LARGE_INTEGER freq, t0, t1, t2; // Capture vs analysis cost
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t0);
+    HDC screenDC = GetDC(nullptr);
+    BitBlt(g_capture.dc, 0, 0, w, h, screenDC, area.left, area.top, SRCCOPY); // No CAPTUREBLT: layered windows stay out
+    ReleaseDC(nullptr, screenDC);
+    GdiFlush(); // Pixels must be in the DIB before the kernels read them
+    QueryPerformanceCounter(&t1);
+    AnalyzeImage(g_analysis, (const BYTE*)g_capture.bits, g_capture.w * 4, w, h, area);
+    g_contrastDirty = true; // New pixels: cell colors are out of date
+    if (g_smartTargets) FindTargets(g_analysis, g_targets);
+    QueryPerformanceCounter(&t2);
+
+    if (g_diagnostics) {
+        UncountedScope uncounted; // Logging is not part of the activation's cost
+        std::wstringstream ss;
+        ss << std::fixed << std::setprecision(3) << L"Vimerate: targets " << g_targets.size() << L" capture "
+           << (t1.QuadPart - t0.QuadPart) * 1000.0 / freq.QuadPart << L" ms, analyze "
+           << (t2.QuadPart - t1.QuadPart) * 1000.0 / freq.QuadPart << L" ms\n";
+        OutputDebugStringW(ss.str().c_str());
+    }
+}
+
+// --- Magnifier ---
+
+// Lens frame and crosshair: a border, a box around the block showing the pixel under the cursor
+// and lines leading to it, leaving the block itself visible. 'c0' is the block's first pixel.
+static void DrawLensMarks(BYTE* dst, int stride, int size, int c0, int zoom) {
+    const uint32_t border = 0xFF404040, mark = 0xFFFF0000; // Opaque gray, opaque red
+    auto put = [&](int x, int y, uint32_t v) {
+        if (x >= 0 && y >= 0 && x < size && y < size) ((uint32_t*)(dst + (size_t)y * stride))[x] = v;
+    };
+    for (int i = 0; i < size; ++i) { put(i, 0, border); put(i, size - 1, border); put(0, i, border); put(size - 1, i, border); }
+    int b0 = c0 - 1, b1 = c0 + zoom; // Box just outside the block
+    for (int i = b0; i <= b1; ++i) { put(i, b0, mark); put(i, b1, mark); put(b0, i, mark); put(b1, i, mark); }
+    int mid = c0 + zoom / 2;
+    for (int i = 1; i < size - 1; ++i)
+        if (i < b0 - 2 || i > b1 + 2) { put(i, mid, mark); put(mid, i, mark); } // Gap around the box
+}
+
+// Copy the screen square around the cursor into g_lensCapture. The overlay is a layered window, so
+// a BitBlt without CAPTUREBLT doesn't see it. Runs when the prompt opens, on nudges and on the timer.
+void CaptureLens() {
+    int maxSide = (LENS_SIZE + MIN_LENS_ZOOM - 1) / MIN_LENS_ZOOM; // Allocated once, for the smallest zoom
+    if (!EnsureSurface(g_lensCapture, maxSide, maxSide)) { g_lensSide = 0; return; }
+    int side = (LENS_SIZE + g_lensZoom - 1) / g_lensZoom; // Source pixels that fill the lens
+    POINT pt;
+    GetCursorPos(&pt);
+    HDC screenDC = GetDC(nullptr);
+    BitBlt(g_lensCapture.dc, 0, 0, side, side, screenDC, pt.x - side / 2, pt.y - side / 2, SRCCOPY);
+    ReleaseDC(nullptr, screenDC);
+    GdiFlush(); // Pixels must be in the DIB before they are copied into a request
+    g_lensSide = side;
+}
+
+// Place the magnifier next to the click prompt: below it, or above if it would leave the grid area.
+// Empty if the area is too small for a lens.
+RECT LensRect(const RECT& promptRc, const RECT& area) {
+    if (area.right - area.left < LENS_SIZE || area.bottom - area.top < LENS_SIZE) return { 0, 0, 0, 0 };
+    LONG lx = std::max(area.left, std::min(promptRc.left, area.right - LENS_SIZE));
+    LONG ly = promptRc.bottom + LENS_MARGIN;
+    if (ly + LENS_SIZE > area.bottom) ly = promptRc.top - LENS_MARGIN - LENS_SIZE;
+    ly = std::max(area.top, std::min(ly, area.bottom - LENS_SIZE));
+    return { lx, ly, lx + LENS_SIZE, ly + LENS_SIZE };
+}
+
+// One frame's band split: band r covers grid row r, cells req->cells[bandStart[r] .. bandStart[r+1])
+struct BandJob {
+    Surface*            surface;  // Target surface; its top-left pixel maps to the frame's top-left
+    const FrameRequest* req;      // What to draw
+    size_t*             bandStart;// rows + 1 offsets into req->cells (frame arena)
+};
+
+// Label box of a cell, centered in it as RenderBand draws it; the cell itself without an atlas entry
+static RECT LabelBoxRect(const RECT& rc, int atlas) {
+    if (atlas < 0 || !g_atlas.view) return rc;
+    const AtlasEntry& e = g_atlas.entries[atlas];
+    LONG bx = std::lround(rc.left + (rc.right - rc.left - e.boxW) / 2);
+    LONG by = std::lround(rc.top + (rc.bottom - rc.top - e.boxH) / 2);
+    return { bx, by, bx + (LONG)std::ceil(e.boxW), by + (LONG)std::ceil(e.boxH) };
+}
+
+// Clear one horizontal band of the grid in its own slice of the surface, and draw into it every
+// label that reaches it. A label box taller than its cell spills into the rows beside it, so the
+// rows around the band are drawn too, clipped to the slice, in row order: overlapping labels
+// composite the same way whichever band draws them.
+static void RenderBand(void* ctx, int band) {
+    const BandJob& job = *(const BandJob*)ctx;
+    const FrameRequest& req = *job.req;
+
+    int y0 = req.rowEdges[band]; // Same edges as the layout
+    int y1 = (band + 1 == req.rows) ? req.area.bottom : req.rowEdges[band + 1];
+    y0 = std::max(y0, (int)req.frame.top); // Only the part of the band inside the frame
+    y1 = std::min(y1, (int)req.frame.bottom);
+    if (y1 <= y0) return;
+
+    int fw = req.frame.right - req.frame.left; // Frame width in pixels
+    int stride = job.surface->w * 4; // Surface may be wider than the frame
+    BYTE* scan0 = (BYTE*)job.surface->bits + (size_t)(y0 - req.frame.top) * stride; // Band's first scanline
+    if (fw == job.surface->w) memset(scan0, 0, (size_t)(y1 - y0) * stride); // Clear with transparent black
+    else for (int y = y0; y < y1; ++y) memset(scan0 + (size_t)(y - y0) * stride, 0, (size_t)fw * 4);
+
+    if (req.cells.empty() || !g_atlas.view) return; // Nothing visible
+
+    int reach = (int)g_atlas.header->tileH / 2 + 1; // Farthest a box reaches past its cell's center
+    int r0 = band, r1 = band; // Rows whose labels can reach the slice: centers lie within their row
+    while (r0 > 0 && req.rowEdges[r0] + reach > y0) --r0;
+    while (r1 + 1 < req.rows && req.rowEdges[r1 + 1] - reach < y1) ++r1;
+
+    for (size_t i = job.bandStart[r0]; i < job.bandStart[r1 + 1]; ++i) { // Pre-rendered labels: colorize and composite
+        const DrawCell& c = req.cells[i];
+        if (c.atlas < 0) continue;
+        RECT b = LabelBoxRect(c.rc, c.atlas);
+        if (b.bottom <= y0 || b.top >= y1) continue; // Entirely in another band
+        BlitLabel(scan0, stride, fw, y1 - y0, b.left - req.frame.left, b.top - y0, c.atlas, c.box, c.text, req.quality);
+    }
+}
+
+// --- Built-in font ---
+// Glyphs, metrics and rasterization live in Core/Font.h.
+
+// Prompt text at the label scale: it sits in its own box, and anything smaller than 2 screen
+// pixels per font pixel is unreadable at 96 DPI
+static int PromptScale() { return g_fontScale; }
+
+// --- Label atlas ---
+
+// FNV-1a, for atlas keys and the payload checksum
+static uint32_t Fnv1a(const void* data, size_t size, uint32_t hash = 2166136261u) {
+    const BYTE* p = (const BYTE*)data;
+    for (size_t i = 0; i < size; ++i) hash = (hash ^ p[i]) * 16777619u;
+    return hash;
+}
+
+// Atlas entry of a label: (first * alphabet + last) * 2 + dotted, i.e. GenerateCells order at full pool
+static int AtlasIndex(const std::wstring& lbl) {
+    if (lbl.length() != 2 && lbl.length() != 3) return -1;
+    size_t a = POOL.find(lbl[0]), b = POOL.find(lbl.back());
+    if (a == std::wstring::npos || b == std::wstring::npos) return -1;
+    return (int)((a * POOL.length() + b) * 2 + (lbl.length() == 3));
+}
+
+// Key fields that decide whether an atlas file matches this run
+static uint32_t AtlasFontHash() {
+    return Fnv1a(FONT_GLYPHS, sizeof(FONT_GLYPHS)); // Glyphs and their order; the scale follows the DPI
+}
+static UINT ScreenDpi() {
+    HDC screenDC = GetDC(nullptr);
+    UINT dpi = (UINT)GetDeviceCaps(screenDC, LOGPIXELSY);
+    ReleaseDC(nullptr, screenDC);
+    return dpi;
+}
+
+// Check a whole atlas file against this run's key; sets up the g_atlas pointers if it matches
+static bool UseAtlasData(const BYTE* data, size_t size, UINT dpi) {
+    if (size < sizeof(AtlasHeader)) return false;
+    const AtlasHeader* h = (const AtlasHeader*)data;
+    size_t labels = POOL.length() * POOL.length() * 2;
+    if (memcmp(h->magic, "VLAT", 4) != 0 || h->version != ATLAS_VERSION) return false; // Not ours, or old layout
+    if (h->alphabetHash != Fnv1a(POOL.data(), POOL.size() * sizeof(wchar_t)) || h->fontHash != AtlasFontHash() ||
+        h->dpi != dpi || h->labels != labels) return false; // Stale: rendered for other settings
+    if (h->tileW == 0 || h->tileH == 0 || h->tileW > 256 || h->tileH > 256) return false;
+    size_t payload = labels * (sizeof(AtlasEntry) + (size_t)h->tileW * h->tileH * 2);
+    if (h->payloadSize != payload || size != sizeof(AtlasHeader) + payload) return false; // Truncated
+    if (h->checksum != Fnv1a(data + sizeof(AtlasHeader), labels * sizeof(AtlasEntry))) return false; // Corrupt entry table
+    g_atlas.view = data; // Tiles are checked as they are first drawn (AtlasTile), so startup reads no mask pages
+    g_atlas.tiles.assign(labels, nullptr);
+    g_atlas.header = h;
+    g_atlas.entries = (const AtlasEntry*)(data + sizeof(AtlasHeader));
+    g_atlas.masks = data + sizeof(AtlasHeader) + labels * sizeof(AtlasEntry);
+    return true;
+}
+
+// Map an existing atlas file read-only; false if missing, stale or corrupt
+static bool MapLabelAtlas(const std::wstring& path, UINT dpi) {
+    LabelAtlas& a = g_atlas;
+    a.file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (a.file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(a.file, &size) && size.QuadPart >= (LONGLONG)sizeof(AtlasHeader) && size.QuadPart < 0x7FFFFFFF) {
+        a.mapping = CreateFileMappingW(a.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const BYTE* view = a.mapping ? (const BYTE*)MapViewOfFile(a.mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (view && UseAtlasData(view, (size_t)size.QuadPart, dpi)) { a.path = path; return true; }
+        if (view) UnmapViewOfFile(view);
+    }
+    UnloadLabelAtlas();
+    return false;
+}
+
+// Rasterize every label of the full alphabet into a complete atlas file image (header included)
+// with the built-in font: per label, a rounded box mask and a text mask, interleaved per pixel.
+static bool BuildLabelAtlas(UINT dpi, std::vector<BYTE>& file) {
+    size_t labels = POOL.length() * POOL.length() * 2;
+    int scale = FontScale(dpi);
+    std::vector<AtlasEntry> entries(labels);
+    wchar_t names[4] = {};
+    auto name = [&](size_t i) { // Label of atlas entry i (AtlasIndex order: the full-pool grid)
+        CellLabel(i, (int)POOL.length(), names);
+        return names;
+    };
+    uint32_t tileW = 0, tileH = 0;
+    for (size_t i = 0; i < labels; ++i) { // Measure first: the tile must fit the largest box
+        int bw = LabelBoxWidth(name(i), scale), bh = LabelBoxHeight(scale);
+        entries[i] = { (float)bw, (float)bh, 0, 0 };
+        tileW = std::max(tileW, (uint32_t)bw);
+        tileH = std::max(tileH, (uint32_t)bh);
+    }
+    if (tileW > 256 || tileH > 256) return false;
+
+    size_t tileBytes = (size_t)tileW * tileH * 2;
+    AtlasHeader h = {};
+    memcpy(h.magic, "VLAT", 4);
+    h.version = ATLAS_VERSION;
+    h.alphabetHash = Fnv1a(POOL.data(), POOL.size() * sizeof(wchar_t));
+    h.fontHash = AtlasFontHash();
+    h.dpi = dpi;
+    h.labels = (uint32_t)labels;
+    h.tileW = tileW;
+    h.tileH = tileH;
+    h.payloadSize = (uint32_t)(labels * (sizeof(AtlasEntry) + tileBytes));
+    file.assign(sizeof(AtlasHeader) + h.payloadSize, 0);
+    BYTE* masks = file.data() + sizeof(AtlasHeader) + labels * sizeof(AtlasEntry);
+
+    for (size_t i = 0; i < labels; ++i) {
+        RasterizeLabel(name(i), scale, masks + i * tileBytes, tileW * 2); // Box at the tile's top-left
+        entries[i].checksum = Fnv1a(masks + i * tileBytes, tileBytes);
+    }
+    memcpy(file.data() + sizeof(AtlasHeader), entries.data(), labels * sizeof(AtlasEntry));
+    h.checksum = Fnv1a(file.data() + sizeof(AtlasHeader), labels * sizeof(AtlasEntry));
+    memcpy(file.data(), &h, sizeof(h));
+    return true;
+}
+
+// Map Settings\LabelAtlas.bin; if it is missing, stale or corrupt, rebuild and rewrite it.
+// Building can't fail at supported scales, so there is always an atlas, on disk or in memory.
+void LoadLabelAtlas() {
+    LARGE_INTEGER freq, t0, t1;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t0);
+    UINT dpi = ScreenDpi();
+    g_fontScale = FontScale(dpi); // The prompt follows the labels' scale
+    std::wstring path = g_settingsDir + L"\\LabelAtlas.bin";
+    bool rebuilt = false;
+    if (!MapLabelAtlas(path, dpi)) {
+        std::vector<BYTE> file;
+        rebuilt = BuildLabelAtlas(dpi, file);
+        if (rebuilt && !(WriteFileBytes(path, file.data(), file.size()) && MapLabelAtlas(path, dpi))) {
+            g_atlas.memory.swap(file); // Settings folder not writable: keep it in memory for this run
+            UseAtlasData(g_atlas.memory.data(), g_atlas.memory.size(), dpi);
         }
-        else if (lbl.length() == 3 && lbl[1] == L'.' && firstCharIdx != std::wstring::npos) { // Dotted label
-            int secondCharIdx = (lbl.length() >= 3) ? (int)POOL.find(lbl[2]) : std::wstring::npos; // Index of third char (after dot)
-            if (secondCharIdx != std::wstring::npos && firstCharIdx < g_poolSize && secondCharIdx < g_poolSize) {
-                c.rc = {
-                    LONG((secondCharIdx + g_poolSize) * cellW), // Shifted for right column
-                    LONG(firstCharIdx * cellH), // Y position
-                    LONG(((secondCharIdx + g_poolSize) + 1) * cellW), // Right edge
-                    LONG((firstCharIdx + 1) * cellH) // Bottom edge
-                };
-            } else { c.rc = { -100, -100, -90, -90 }; } // Mark invalid
+    }
+    QueryPerformanceCounter(&t1);
+
+    if (g_diagnostics) {
+        std::wstringstream ss;
+        ss << std::fixed << std::setprecision(3) << L"Vimerate: label atlas "
+           << (!g_atlas.view ? L"unavailable" : rebuilt ? L"rebuilt" : L"mapped") << L" in "
+           << (t1.QuadPart - t0.QuadPart) * 1000.0 / freq.QuadPart << L" ms\n";
+        OutputDebugStringW(ss.str().c_str());
+    }
+}
+
+// Release the atlas view, mapping and file
+void UnloadLabelAtlas() {
+    LabelAtlas& a = g_atlas;
+    size_t tileBytes = a.header ? (size_t)a.header->tileW * a.header->tileH * 2 : 0;
+    for (size_t i = 0; i < a.tiles.size(); ++i) // Tiles re-rasterized by AtlasTile
+        if (a.tiles[i] && a.tiles[i] != a.masks + i * tileBytes) delete[] (BYTE*)a.tiles[i];
+    if (a.mapping && a.view) UnmapViewOfFile(a.view);
+    if (a.mapping) CloseHandle(a.mapping);
+    if (a.file != INVALID_HANDLE_VALUE) CloseHandle(a.file);
+    if (a.corrupt && !a.path.empty()) DeleteFileW(a.path.c_str()); // Rebuilt at the next start
+    a = LabelAtlas();
+}
+
+// Tile of an atlas entry. Its checksum is checked the first time it is drawn, so the pages of the
+// mapping are only read for labels that are shown. A damaged tile is rasterized again in memory and
+// the file is deleted at unload. Render workers race here harmlessly: the first tile published wins.
+static const BYTE* AtlasTile(int index) {
+    LabelAtlas& a = g_atlas;
+    if (void* t = InterlockedCompareExchangePointer(&a.tiles[index], nullptr, nullptr)) return (const BYTE*)t;
+    size_t tileBytes = (size_t)a.header->tileW * a.header->tileH * 2;
+    const BYTE* tile = a.masks + (size_t)index * tileBytes;
+    BYTE* copy = nullptr;
+    if (Fnv1a(tile, tileBytes) != a.entries[index].checksum) {
+        InterlockedExchange(&a.corrupt, 1);
+        wchar_t lbl[4];
+        CellLabel((size_t)index, (int)POOL.length(), lbl); // AtlasIndex order
+        copy = new BYTE[tileBytes]();
+        RasterizeLabel(lbl, g_fontScale, copy, (int)a.header->tileW * 2);
+        tile = copy;
+    }
+    void* first = InterlockedCompareExchangePointer(&a.tiles[index], (void*)tile, nullptr);
+    if (!first) return tile;
+    delete[] copy; // Another worker published it first
+    return (const BYTE*)first;
+}
+
+// Composite one atlas label at (x, y) of a w x h premultiplied BGRA slice, at a governor quality level
+static void BlitLabel(BYTE* scan0, int stride, int w, int h, int x, int y, int index,
+                      Gdiplus::ARGB box, Gdiplus::ARGB text, int quality) {
+    const AtlasHeader& hd = *g_atlas.header;
+    const BYTE* tile = AtlasTile(index);
+    if (quality == QUALITY_FULL)
+        BlitCoverage(scan0, stride, w, h, x, y, tile, (int)hd.tileW, (int)hd.tileH, box, text);
+    else
+        BlitCoverageHard(scan0, stride, w, h, x, y, tile, (int)hd.tileW, g_atlas.entries[index].boxW,
+                         g_atlas.entries[index].boxH, box, text, quality >= QUALITY_SQUARE);
+}
+
+// Premultiplied BGRA pixel of an ARGB color
+static inline uint32_t Premultiply(Gdiplus::ARGB c) {
+    int a = (c >> 24) & 0xFF;
+    return (uint32_t)a << 24 | (uint32_t)Mul255((c >> 16) & 0xFF, a) << 16 | (uint32_t)Mul255((c >> 8) & 0xFF, a) << 8 |
+           (uint32_t)Mul255(c & 0xFF, a);
+}
+
+// Premultiplied 'src' over 'dst'; 'inv' is 255 minus src's alpha (0 for opaque colors: a plain store)
+static inline uint32_t OverPremultiplied(uint32_t src, int inv, uint32_t dst) {
+    if (!inv) return src;
+    return src + ((uint32_t)Mul255(dst >> 24, inv) << 24 | (uint32_t)Mul255((dst >> 16) & 0xFF, inv) << 16 |
+                  (uint32_t)Mul255((dst >> 8) & 0xFF, inv) << 8 | (uint32_t)Mul255(dst & 0xFF, inv));
+}
+
+// Degraded BlitCoverage for the governor: coverage is thresholded at one half, so each pixel is the
+// box and/or text color composited over what is there, with no per-pixel coverage products. Labels
+// can overlap their neighbors, so a translucent box still shows what it covers, as at full quality.
+// Draws the top-left cw x ch of masks that are mw pixels wide; with 'square', the whole cw x ch box
+// is filled, ignoring its mask.
+static void BlitCoverageHard(BYTE* scan0, int stride, int w, int h, int x, int y, const BYTE* tile, int mw,
+                             int cw, int ch, Gdiplus::ARGB box, Gdiplus::ARGB text, bool square) {
+    uint32_t bp = Premultiply(box), tp = Premultiply(text);
+    int binv = 255 - (int)(bp >> 24), tinv = 255 - (int)(tp >> 24);
+    int tx0 = std::max(0, -x), ty0 = std::max(0, -y); // Clip the box to the slice
+    int tx1 = std::min(cw, w - x), ty1 = std::min(ch, h - y);
+    for (int ty = ty0; ty < ty1; ++ty) {
+        const BYTE* m = tile + ((size_t)ty * mw + tx0) * 2;
+        uint32_t* d = (uint32_t*)(scan0 + (size_t)(y + ty) * stride) + x + tx0;
+        for (int tx = tx0; tx < tx1; ++tx, m += 2, ++d) {
+            bool inBox = square || m[0] >= 128, inText = m[1] >= 128;
+            if (!inBox && !inText) continue;
+            uint32_t v = *d;
+            if (inBox) v = OverPremultiplied(bp, binv, v);
+            if (inText) v = OverPremultiplied(tp, tinv, v);
+            *d = v;
+        }
+    }
+}
+
+// Bounding box (screen coordinates) of everything the current state draws; cells must be laid out
+RECT FrameBounds(const RECT& area) {
+    if (g_filtered.size() * 2 > g_cells.size()) return area; // Dense frame: not worth computing
+
+    RECT box = { area.right, area.bottom, area.left, area.top }; // Empty until something is added
+    auto add = [&box](const RECT& r) {
+        box.left = std::min(box.left, r.left); box.top = std::min(box.top, r.top);
+        box.right = std::max(box.right, r.right); box.bottom = std::max(box.bottom, r.bottom);
+    };
+    for (auto c : g_filtered)
+        if (c->rc.right > c->rc.left) { add(c->rc); add(LabelBoxRect(c->rc, AtlasIndex(c->lbl))); } // A box may outgrow its cell
+    if (g_grid.state == WAIT_CLICK && g_filtered.size() == 1) {
+        RECT pr = PromptRect(g_filtered[0]->rc, area, PromptScale());
+        add(pr);
+        RECT lr = LensRect(pr, area); // Empty when there is no room: nothing drawn, nothing to add
+        if (g_magnifier && g_lensSide && lr.right > lr.left) add(lr); // Same test as BuildFrameRequest
+    }
+
+    box.left = std::max(box.left, area.left); box.top = std::max(box.top, area.top); // Stay inside the grid
+    box.right = std::min(box.right, area.right); box.bottom = std::min(box.bottom, area.bottom);
+    if (box.right <= box.left || box.bottom <= box.top) return { area.left, area.top, area.left + 1, area.top + 1 }; // Nothing visible
+    return box;
+}
+
+// Snapshot the current grid state into a request: lays out cells for 'area', picks the frame
+// bounds and copies the visible cells. Runs on the UI thread; reuses the request's capacity.
+void BuildFrameRequest(FrameRequest& req, const RECT& area) {
+    req.cells.clear();
+    req.prompt = false;
+    req.lens = false;
+    req.color = g_cellColor;
+    req.quality = g_quality;
+    if (g_grid.state == HIDDEN) { // Empty 1x1 frame: clears the overlay so the next show starts blank
+        req.area = req.frame = { area.left, area.top, area.left + 1, area.top + 1 };
+        req.rows = 1;
+        req.rowEdges.assign({ area.top, area.top + 1 });
+        return;
+    }
+
+    LayoutCells(area); // Input handling reads these rectangles too
+    req.area = area;
+    req.frame = FrameBounds(area); // Only what is drawn gets allocated, cleared and blended
+    req.rows = g_gridPool;
+    req.rowEdges.assign(g_rowEdges.begin(), g_rowEdges.end()); // Reuses capacity
+    if (req.cells.capacity() < g_filtered.size()) req.cells.reserve(g_cells.size()); // Once per grid size
+    // Sparse level: a checkerboard of the untyped grid. Each hidden label shares its row letter with
+    // the labels beside it and its column letter with those above and below, so it can still be read off.
+    // The first key filters the grid down to the labels starting with it, which are all drawn: that
+    // frame covers a fraction of the area, so it stays cheap at any level.
+    bool sparse = req.quality >= QUALITY_SPARSE && g_grid.state == SHOW_ALL && g_grid.typed.empty();
+    for (auto c : g_filtered) { // g_filtered keeps g_cells' row-major order
+        if (c->rc.right <= c->rc.left) continue; // Invalid cell
+        if (sparse) {
+            size_t row, col;
+            CellPosition((size_t)(c - g_cells.data()), g_gridPool, row, col); // GenerateCells order, as in LayoutCells
+            if ((row + col) & 1) continue;
         }
-        else {
-            c.rc = { -100, -100, -90, -90 }; // Mark invalid
+        DrawCell d;
+        d.rc = c->rc;
+        d.row = (int)POOL.find(c->lbl[0]); // First char selects the row
+        size_t n = std::min(c->lbl.size(), (size_t)3);
+        std::copy(c->lbl.begin(), c->lbl.begin() + n, d.lbl);
+        d.lbl[n] = L'\0';
+        d.atlas = AtlasIndex(c->lbl);
+        d.box = c->box ? c->box : req.color.GetValue(); // Adaptive colors, else the user's color
+        d.text = c->text ? c->text : Gdiplus::Color::MakeARGB(255, 0, 0, 0); // Black text
+        req.cells.push_back(d);
+    }
+    if (g_grid.state == WAIT_CLICK && g_filtered.size() == 1) { // Waiting for click on one cell
+        req.prompt = true;
+        req.promptRc = PromptRect(g_filtered[0]->rc, area, PromptScale()); // Same clamping rules as always
+        req.lensRc = LensRect(req.promptRc, area);
+        if (g_magnifier && g_lensSide && req.lensRc.right > req.lensRc.left) { // Copy, so the next capture can't tear it
+            req.lens = true;
+            req.lensZoom = g_lensZoom;
+            req.lensBilinear = g_lensBilinear && req.quality == QUALITY_FULL; // Nearest is several times cheaper
+            req.lensSide = g_lensSide;
+            req.lensPixels.resize((size_t)g_lensSide * g_lensSide * 4); // Reuses capacity
+            for (int y = 0; y < g_lensSide; ++y)
+                memcpy(&req.lensPixels[(size_t)y * g_lensSide * 4], (const BYTE*)g_lensCapture.bits + (size_t)y * g_lensCapture.w * 4,
+                       (size_t)g_lensSide * 4);
         }
     }
+}
 
-    // Draw filtered cells
-    for (auto c : g_filtered) {
-        if (c->rc.left >= 0 && c->rc.top >= 0) { // If cell is valid
-            RECT rc = c->rc; // Cell rectangle
-            RectF layoutRect((FLOAT)rc.left, (FLOAT)rc.top, (FLOAT)(rc.right - rc.left), (FLOAT)(rc.bottom - rc.top)); // GDI+ rectangle
+// Rasterize a request's frame region into the top-left of a surface. Reads nothing but the
+// request, so it can run on any thread.
+void RenderFrame(Surface& surface, const FrameRequest& req) {
+    GdiFlush(); // Finish pending GDI work before touching the bits
+
+    // Bucket cells by grid row
+    BandJob job = { &surface, &req, nullptr };
+    job.bandStart = g_frameArena.Alloc<size_t>(req.rows + 1); // Scratch, freed by Reset after rendering
+    std::fill(job.bandStart, job.bandStart + req.rows + 1, (size_t)0);
+    for (const auto& c : req.cells)
+        if (c.row >= 0 && c.row < req.rows) ++job.bandStart[c.row + 1];
+    for (int r = 0; r < req.rows; ++r) job.bandStart[r + 1] += job.bandStart[r]; // Counts to start offsets
+
+    RunParallel(req.rows, RenderBand, &job); // Clear and draw all bands concurrently
+
+    if (req.lens) { // Magnifier: scaled straight into the surface, then marked
+        int stride = surface.w * 4;
+        BYTE* dst = (BYTE*)surface.bits + (size_t)(req.lensRc.top - req.frame.top) * stride + (size_t)(req.lensRc.left - req.frame.left) * 4;
+        const BYTE* src = req.lensPixels.data();
+        if (req.lensBilinear)
+            ScaleBilinearBGRA(src, req.lensSide * 4, req.lensSide, req.lensSide, req.lensZoom, dst, stride, LENS_SIZE, LENS_SIZE,
+                              g_frameArena.Alloc<uint16_t>((size_t)LENS_SIZE * 8)); // Two expanded rows
+        else
+            ScaleNearestBGRA(src, req.lensSide * 4, req.lensSide, req.lensSide, req.lensZoom, dst, stride, LENS_SIZE, LENS_SIZE);
+        DrawLensMarks(dst, stride, LENS_SIZE, req.lensSide / 2 * req.lensZoom, req.lensZoom);
+    }
 
-            RectF unlimitedRect(0, 0, 1000, layoutRect.Height); // Large rect for measuring text
-            RectF textBounds; // Bounds of text
-            mg.MeasureString(c->lbl.c_str(), -1, &font, unlimitedRect, &textBounds); // Measure text size
+    if (req.prompt) { // If waiting for click and one cell: box and text masks, composited like a label
+        const RECT& pr = req.promptRc;
+        int pw = pr.right - pr.left, ph = pr.bottom - pr.top, scale = PromptScale();
+        BYTE* masks = g_frameArena.Alloc<BYTE>((size_t)pw * ph * 2); // Scratch, freed by Reset after rendering
+        memset(masks, 0, (size_t)pw * ph * 2);
+        RasterizePrompt(PROMPT_TEXT, scale, masks, pw, ph);
+        int fw = req.frame.right - req.frame.left, fh = req.frame.bottom - req.frame.top;
+        BlitCoverage((BYTE*)surface.bits, surface.w * 4, fw, fh, pr.left - req.frame.left, pr.top - req.frame.top, masks, pw, ph,
+                     Gdiplus::Color::MakeARGB(255, 173, 216, 230), Gdiplus::Color::MakeARGB(255, 0, 0, 0)); // Light blue, black text
+    }
+    GdiFlush(); // GDI batches per thread: flush before another thread reads the DC
+}
 
-            float bx = layoutRect.X + (layoutRect.Width - textBounds.Width) / 2 - 1; // Box X position
-            float by = layoutRect.Y + (layoutRect.Height - textBounds.Height) / 2 - 1; // Box Y position
-            RectF boxRect(bx, by, textBounds.Width + 2, textBounds.Height + 2); // Box around text
+// Worker thread: wait for a job permit, claim bands until none are left, report completion
+static DWORD WINAPI WorkerMain(LPVOID) {
+    for (;;) {
+        WaitForSingleObject(g_pool.startSem, INFINITE);
+        if (g_pool.quit) return 0;
+        LONG band;
+        while ((band = InterlockedIncrement(&g_pool.nextBand) - 1) < g_pool.bandCount)
+            g_pool.fn(g_pool.ctx, (int)band);
+        if (InterlockedDecrement(&g_pool.pending) == 0) SetEvent(g_pool.doneEvent); // Last one out
+    }
+}
 
-            DrawRounded(mg, boxRect, &cellBrush); // Draw rounded rectangle
-            mg.DrawString(c->lbl.c_str(), -1, &font, boxRect, &sf, &textBrush); // Draw text
+// Create one worker per core beyond the calling thread
+void StartWorkerPool() {
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    int workers = std::min((int)si.dwNumberOfProcessors - 1, 63); // Caller is a worker too; WaitForMultipleObjects limit
+    g_pool.startSem = CreateSemaphoreW(nullptr, 0, 64, nullptr);
+    g_pool.doneEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr); // Auto-reset
+    for (int i = 0; i < workers; ++i) {
+        HANDLE t = CreateThread(nullptr, 0, WorkerMain, nullptr, 0, nullptr);
+        if (t) g_pool.threads.push_back(t);
+    }
+}
+
+// Stop and join all workers
+void StopWorkerPool() {
+    g_pool.quit = true;
+    if (!g_pool.threads.empty()) {
+        ReleaseSemaphore(g_pool.startSem, (LONG)g_pool.threads.size(), nullptr); // Wake everyone to exit
+        WaitForMultipleObjects((DWORD)g_pool.threads.size(), g_pool.threads.data(), TRUE, INFINITE);
+    }
+    for (HANDLE t : g_pool.threads) CloseHandle(t);
+    g_pool.threads.clear();
+    if (g_pool.startSem) CloseHandle(g_pool.startSem);
+    if (g_pool.doneEvent) CloseHandle(g_pool.doneEvent);
+    g_pool.startSem = g_pool.doneEvent = nullptr;
+}
+
+// Run fn for bands 0..count-1 on all workers plus the calling thread, and wait for completion.
+// Bands are claimed one at a time from a shared counter, so uneven bands balance themselves.
+void RunParallel(int count, BandFn fn, void* ctx) {
+    int workers = (int)g_pool.threads.size();
+    g_pool.fn = fn;
+    g_pool.ctx = ctx;
+    g_pool.bandCount = count;
+    g_pool.nextBand = 0;
+    g_pool.pending = workers;
+    if (workers > 0) ReleaseSemaphore(g_pool.startSem, workers, nullptr); // One permit per worker
+
+    LONG band;
+    while ((band = InterlockedIncrement(&g_pool.nextBand) - 1) < count)
+        fn(ctx, (int)band); // The caller claims bands too
+    if (workers > 0) WaitForSingleObject(g_pool.doneEvent, INFINITE);
+}
+
+// Layout the grid and hand the frame to the render thread; presentation follows via WM_APP_PRESENT
+void LayoutAndDraw(HWND hWnd, const RECT& area) {
+    BuildFrameRequest(*g_handoff.producer, area); // Cheap: layout and copies, no rasterization
+    g_handoff.producer->target = hWnd;
+    PublishFrameRequest();
+
+    if (g_renderThread) { SetEvent(g_renderWake); return; } // Render thread picks it up
+    if (g_handoff.Take() && RenderToBuffer(g_buffers[0], *g_handoff.consumer)) // No thread: render inline
+        PresentBuffer(hWnd, g_buffers[0]);
+}
+
+// Hide the overlay and queue an empty frame, so the next show doesn't flash the previous grid
+void HideGrid(HWND hWnd) {
+    LogEvent(TEL_HIDE, 0, 0, 0);
+    g_grid.state = HIDDEN;
+    KillTimer(hWnd, LENS_TIMER_ID); // No-op unless the lens was refreshing
+    ShowWindow(hWnd, SW_HIDE);
+    LayoutAndDraw(hWnd, g_gridRect);
+}
+
+// UI thread: number the filled request and publish it; g_handoff.producer is the slot it replaced
+static void PublishFrameRequest() {
+    g_handoff.producer->seq = ++g_requestSeq;
+    g_handoff.Publish();
+}
+
+// Rasterize a request into a back buffer, growing it if needed
+static bool RenderToBuffer(RenderBuffer& buf, const FrameRequest& req) {
+    int fw = req.frame.right - req.frame.left, fh = req.frame.bottom - req.frame.top;
+    if (buf.surface.w < fw || buf.surface.h < fh) // Grow only, so size changes don't reallocate per frame
+        EnsureSurface(buf.surface, std::max(buf.surface.w, fw), std::max(buf.surface.h, fh));
+    if (!buf.surface.bmp) return false; // No surface: nothing to present
+
+    LARGE_INTEGER freq, t0, t1; // Raster time, reported when the frame is presented
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t0);
+    RenderFrame(buf.surface, req); // Pure rasterization
+    QueryPerformanceCounter(&t1);
+    g_frameArena.Reset(); // Frame rendered: scratch memory is free again
+    buf.frame = req.frame;
+    buf.seq = req.seq;
+    buf.rasterMs = (t1.QuadPart - t0.QuadPart) * 1000.0 / freq.QuadPart;
+    buf.quality = req.quality;
+    buf.fullGrid = !req.cells.empty() && memcmp(&req.frame, &req.area, sizeof(RECT)) == 0;
+
+    if (g_dumpFrames) { // Keep a copy of every rendered frame
+        UncountedScope uncounted; // Not part of the frame's cost
+        std::wstring dir = g_settingsDir + L"\\Frames";
+        CreateDirectoryW(dir.c_str(), nullptr);
+        std::wstringstream name;
+        name << dir << L"\\frame_" << std::setw(5) << std::setfill(L'0') << ++g_frameCounter << L".pam";
+        WriteFrameImage(buf.surface, fw, fh, name.str());
+    }
+    return true;
+}
+
+// Render thread: wait for requests, render the newest into a free back buffer, post it to the UI thread.
+// If both buffers are still waiting to be presented it blocks until one comes back, then takes the
+// newest request at that point, so a slow UI thread costs skipped frames, never stale ones.
+static DWORD WINAPI RenderThreadMain(LPVOID) {
+    for (;;) {
+        WaitForSingleObject(g_renderWake, INFINITE);
+        while (!g_renderQuit) {
+            int idx = !g_buffers[0].ready ? 0 : !g_buffers[1].ready ? 1 : -1;
+            if (idx < 0) { WaitForSingleObject(g_bufferFreed, INFINITE); continue; }
+            if (!g_handoff.Take()) break; // Up to date: sleep until the next request
+            RenderBuffer& buf = g_buffers[idx];
+            if (!RenderToBuffer(buf, *g_handoff.consumer)) continue;
+            InterlockedExchange(&buf.ready, 1); // Buffer now belongs to the UI thread
+            if (!PostMessageW(g_handoff.consumer->target, WM_APP_PRESENT, (WPARAM)idx, 0))
+                InterlockedExchange(&buf.ready, 0); // Window gone: take it back
         }
+        if (g_renderQuit) return 0;
     }
+}
 
-    if (g_state == WAIT_CLICK && g_filtered.size() == 1) { // If waiting for click and one cell
-        Cell* sel = g_filtered[0]; // Selected cell
-        RECT rc = sel->rc; // Selected cell rectangle
-        std::wstring promptText = L"1=Left 2=Right 3=Double"; // Prompt text
+// Create the render thread and its wake-up events
+void StartRenderThread() {
+    g_renderWake = CreateEventW(nullptr, FALSE, FALSE, nullptr); // Auto-reset
+    g_bufferFreed = CreateEventW(nullptr, FALSE, FALSE, nullptr); // Auto-reset
+    if (g_renderWake && g_bufferFreed)
+        g_renderThread = CreateThread(nullptr, 0, RenderThreadMain, nullptr, 0, nullptr); // Else render inline
+}
 
-        int promptMargin = 8; // Margin for prompt box
-        int promptWidth = 160; // Prompt box width
-        int promptHeight = 25; // Prompt box height
+// Stop and join the render thread; afterwards the UI thread owns every buffer again
+void StopRenderThread() {
+    if (g_renderThread) {
+        g_renderQuit = true;
+        SetEvent(g_renderWake); // Wake it wherever it is waiting
+        SetEvent(g_bufferFreed);
+        WaitForSingleObject(g_renderThread, INFINITE);
+        CloseHandle(g_renderThread);
+        g_renderThread = nullptr;
+    }
+    if (g_renderWake) CloseHandle(g_renderWake);
+    if (g_bufferFreed) CloseHandle(g_bufferFreed);
+    g_renderWake = g_bufferFreed = nullptr;
+}
 
-        int px = rc.right + promptMargin; // Prompt X position (right of cell)
-        int py = rc.top + ((rc.bottom - rc.top) / 2) - (promptHeight / 2); // Prompt Y position (centered)
+// Frame-time governor (UI thread): a full-grid frame over budget drops one level right away, since
+// the user has already waited for it; GOVERNOR_UP_FRAMES fast ones in a row climb back one level.
+// Only full-grid frames count: the small frames while typing are cheap at any level.
+static void GovernFrame(double ms) {
+    if (g_frameBudgetMs <= 0) return;
+    int level = g_quality;
+    if (ms > g_frameBudgetMs) {
+        g_qualityCalm = 0;
+        level = std::min(level + 1, QUALITY_LEVELS - 1);
+    } else if (ms < g_frameBudgetMs * GOVERNOR_HEADROOM) {
+        if (level > QUALITY_FULL && ++g_qualityCalm >= GOVERNOR_UP_FRAMES) { g_qualityCalm = 0; --level; }
+    } else {
+        g_qualityCalm = 0; // Within budget, but no room to spare: stay
+    }
+    if (level == g_quality) return;
+
+    UncountedScope uncounted; // Rare, and always logged: it explains what the user sees
+    std::wstringstream ss;
+    ss << std::fixed << std::setprecision(3) << L"Vimerate: quality " << QUALITY_NAMES[g_quality] << L" -> "
+       << QUALITY_NAMES[level] << L" after a " << ms << L" ms frame (budget " << g_frameBudgetMs << L" ms)\n";
+    OutputDebugStringW(ss.str().c_str());
+    g_quality = level;
+}
 
-        if (px + promptWidth > W) { // If prompt goes off screen right
-            px = rc.left - promptWidth - promptMargin; // Move to left of cell
-            if (px < 0) px = 0; // Clamp to left edge
+// UI thread: put a finished buffer on screen, then give it back to the render thread
+void PresentBuffer(HWND hWnd, RenderBuffer& buf) {
+    if (buf.seq > g_presentedSeq) { // Never step back to an older frame
+        int fw = buf.frame.right - buf.frame.left, fh = buf.frame.bottom - buf.frame.top;
+        LARGE_INTEGER freq, t0, t1; // Compositor cost
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&t0);
+        POINT ptPos = { buf.frame.left, buf.frame.top }; // Window moves to the content
+        SIZE sizeWnd = { fw, fh }; // Window size = content size
+        POINT ptSrc = { 0, 0 }; // Frame is rendered at the surface's top-left
+        BLENDFUNCTION blend = { AC_SRC_OVER, 0, 255, AC_SRC_ALPHA }; // Blending function for transparency
+        // Update layered window straight from the back buffer's DIB section (no intermediate copy)
+        UpdateLayeredWindow(hWnd, nullptr, &ptPos, &sizeWnd, buf.surface.dc, &ptSrc, 0, &blend, ULW_ALPHA);
+        QueryPerformanceCounter(&t1);
+        g_presentedSeq = buf.seq;
+        double presentMs = (t1.QuadPart - t0.QuadPart) * 1000.0 / freq.QuadPart;
+        if (buf.fullGrid) GovernFrame(buf.rasterMs + presentMs);
+        if (buf.frame.right - buf.frame.left > 1) // Not the 1x1 clearing frame
+            LogEvent(TEL_FRAME, (uint16_t)(buf.quality | (buf.fullGrid ? 0x100 : 0)), (uint32_t)(buf.rasterMs * 1000),
+                     (uint32_t)(presentMs * 1000));
+
+        if (g_diagnostics) { // Report raster vs present time, and frames skipped in between
+            UncountedScope uncounted; // Logging is not part of the frame's cost
+            std::wstringstream ss;
+            ss << std::fixed << std::setprecision(3) << L"Vimerate: frame " << fw << L"x" << fh << L" raster "
+               << buf.rasterMs << L" ms, present " << presentMs << L" ms, superseded " << (g_requestSeq - buf.seq)
+               << L", quality " << QUALITY_NAMES[buf.quality] << L"\n";
+            OutputDebugStringW(ss.str().c_str());
         }
-        if (py < 0) py = 0; // Clamp to top edge
-        if (py + promptHeight > H) py = H - promptHeight; // Clamp to bottom edge
+    }
+    InterlockedExchange(&buf.ready, 0); // Render thread may draw into it again
+    if (g_bufferFreed) SetEvent(g_bufferFreed);
+}
 
-        RectF promptRect((REAL)px, (REAL)py, (REAL)promptWidth, (REAL)promptHeight); // Prompt rectangle
-        SolidBrush promptBg(Color(255, 173, 216, 230)); // Prompt background color
-        SolidBrush promptTextBrush(Color(255, 0, 0, 0)); // Prompt text color
+// Save a surface to disk: .ppm writes RGB composited over black, anything else writes PAM with straight alpha
+bool WriteFrameImage(const Surface& surface, int w, int h, const std::wstring& path) {
+    bool ppm = path.size() >= 4 && _wcsicmp(path.c_str() + path.size() - 4, L".ppm") == 0; // Pick format by extension
+    int channels = ppm ? 3 : 4;
+
+    std::string header; // Netpbm header
+    if (ppm) header = "P6\n" + std::to_string(w) + " " + std::to_string(h) + "\n255\n";
+    else header = "P7\nWIDTH " + std::to_string(w) + "\nHEIGHT " + std::to_string(h) +
+                  "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+
+    std::vector<BYTE> data(header.begin(), header.end()); // Whole file, written in one call
+    data.reserve(header.size() + (size_t)w * h * channels);
+    for (int i = 0; i < w * h; ++i) {
+        const BYTE* px = (const BYTE*)surface.bits + ((size_t)(i / w) * surface.w + i % w) * 4; // Premultiplied BGRA, top-down
+        BYTE a = px[3];
+        if (ppm) { // Premultiplied color is already the composite over black
+            data.push_back(px[2]); data.push_back(px[1]); data.push_back(px[0]);
+        } else { // Un-premultiply for straight-alpha PAM
+            data.push_back(a ? (BYTE)(px[2] * 255 / a) : 0);
+            data.push_back(a ? (BYTE)(px[1] * 255 / a) : 0);
+            data.push_back(a ? (BYTE)(px[0] * 255 / a) : 0);
+            data.push_back(a);
+        }
+    }
 
-        DrawRounded(mg, promptRect, &promptBg); // Draw rounded prompt background
+    return WriteFileBytes(path, data.data(), data.size());
+}
 
-        Font promptFont(L"Arial", 10, FontStyleRegular); // Font for prompt text
-        StringFormat promptFormat; // String format for prompt text
-        promptFormat.SetAlignment(StringAlignmentNear); // Align near (left)
-        promptFormat.SetLineAlignment(StringAlignmentCenter); // Center vertically
+// Load a PPM (P6) or PAM (P7 with DEPTH 3 or 4) as 32bpp BGRA; used for screenshot fixtures
+bool ReadFrameImage(const std::wstring& path, std::vector<BYTE>& bgra, int& w, int& h) {
+    std::string data;
+    if (!ReadFileBytes(path, data)) return false;
+    std::istringstream in(data);
+    std::string magic;
+    int depth = 3, maxval = 0;
+    w = h = 0;
+    in >> magic;
+    if (magic == "P6") in >> w >> h >> maxval;
+    else if (magic == "P7") {
+        std::string key;
+        while (in >> key && key != "ENDHDR") {
+            if (key == "WIDTH") in >> w;
+            else if (key == "HEIGHT") in >> h;
+            else if (key == "DEPTH") in >> depth;
+            else if (key == "MAXVAL") in >> maxval;
+            else std::getline(in, key); // TUPLTYPE and anything else
+        }
+    }
+    else return false;
+    in.get(); // Single whitespace before the pixels
+    if (!in || w <= 0 || h <= 0 || maxval != 255 || (depth != 3 && depth != 4)) return false;
+
+    size_t offset = (size_t)in.tellg(), count = (size_t)w * h;
+    if (data.size() < offset + count * depth) return false; // Truncated
+    bgra.resize(count * 4);
+    const BYTE* src = (const BYTE*)data.data() + offset;
+    for (size_t i = 0; i < count; ++i, src += depth) { // RGB(A) to BGRA
+        bgra[i * 4] = src[2];
+        bgra[i * 4 + 1] = src[1];
+        bgra[i * 4 + 2] = src[0];
+        bgra[i * 4 + 3] = depth == 4 ? src[3] : 255;
+    }
+    return true;
+}
 
-        RectF promptTextRect = promptRect; // Text rectangle
-        promptTextRect.X += 6; // Indent text slightly
+// Write a whole file in one call (replaces existing content)
+bool WriteFileBytes(const std::wstring& path, const void* data, size_t size) {
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    DWORD written = 0;
+    BOOL ok = WriteFile(file, data, (DWORD)size, &written, nullptr);
+    CloseHandle(file);
+    return ok && written == size;
+}
 
-        mg.DrawString(promptText.c_str(), -1, &promptFont, promptTextRect, &promptFormat, &promptTextBrush); // Draw prompt text
+// Read a whole file into a byte string
+bool ReadFileBytes(const std::wstring& path, std::string& out) {
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    bool ok = GetFileSizeEx(file, &size) && size.QuadPart < 0x7FFFFFFF; // Small text/binary files only
+    if (ok) {
+        out.resize((size_t)size.QuadPart);
+        DWORD read = 0;
+        ok = out.empty() || (ReadFile(file, &out[0], (DWORD)out.size(), &read, nullptr) && read == out.size());
     }
+    CloseHandle(file);
+    return ok;
+}
 
-    POINT ptPos = { 0, 0 }; // Window position
-    SIZE sizeWnd = { W, H }; // Window size
-    POINT ptSrc = { 0, 0 }; // Source point for blitting
-    BLENDFUNCTION blend = { AC_SRC_OVER, 0, 255, AC_SRC_ALPHA }; // Blending function for transparency
-    // Update layered window with blended bitmap
-    UpdateLayeredWindow(hWnd, screenDC, &ptPos, &sizeWnd, memDC, &ptSrc, 0, &blend, ULW_ALPHA);
+// --render <out.ppm|out.pam> [--size WxH] [--typed LABEL] [--pool N] [--capture screen.ppm|.pam] [--focus X,Y]
+// Renders one frame offscreen with the current settings. An empty prefix renders SHOW_ALL,
+// a partial prefix renders the filtered grid, and a complete label renders WAIT_CLICK.
+// --capture runs target detection on a screenshot fixture and renders at its size.
+// --focus renders the foveated layout centered on X,Y.
+int RunRenderCommand(int argc, wchar_t** argv) {
+    if (argc < 3) return 2; // Output path is required
+    std::wstring outPath = argv[2];
+    int W = GetSystemMetrics(SM_CXSCREEN), H = GetSystemMetrics(SM_CYSCREEN); // Default to screen size
+    std::wstring typed, capturePath;
+
+    for (int i = 3; i + 1 < argc; i += 2) { // Option/value pairs
+        std::wstring opt = argv[i];
+        if (opt == L"--size") { // WxH
+            wchar_t x = 0;
+            std::wstringstream ss(argv[i + 1]);
+            if (!(ss >> W >> x >> H) || x != L'x') return 2;
+        }
+        else if (opt == L"--typed") typed = argv[i + 1];
+        else if (opt == L"--capture") capturePath = argv[i + 1];
+        else if (opt == L"--focus") { // X,Y
+            wchar_t c = 0;
+            std::wstringstream ss(argv[i + 1]);
+            if (!(ss >> g_focus.x >> c >> g_focus.y) || c != L',') return 2;
+            g_foveated = true;
+        }
+        else if (opt == L"--pool") g_poolSize = std::max(MIN_POOL_SIZE, std::min(_wtoi(argv[i + 1]), (int)POOL.length()));
+        else if (opt == L"--quality") g_quality = std::max(0, std::min(_wtoi(argv[i + 1]), QUALITY_LEVELS - 1)); // Governor level
+        else return 2; // Unknown option
+    }
+    if (W <= 0 || H <= 0) return 2;
+    if (!capturePath.empty()) { // Screenshot fixture: place labels on targets found in it
+        std::vector<BYTE> capture;
+        if (!ReadFrameImage(capturePath, capture, W, H)) return 2; // Frame takes the fixture's size
+        DetectTargets(g_analysis, capture.data(), W * 4, W, H, g_targets);
+        g_smartTargets = true;
+    }
 
-    SelectObject(memDC, oldBmp); // Restore old bitmap
-    DeleteObject(hBmp); // Delete created bitmap
-    DeleteDC(memDC); // Delete memory DC
-    ReleaseDC(nullptr, screenDC); // Release screen DC
+    GenerateCells(g_poolSize);
+    g_grid.typed = typed;
+    g_grid.state = SHOW_ALL; // Typing state: the cells that start with the prefix
+    FilterCells();
+    if (g_filtered.size() == 1 && g_filtered[0]->lbl == typed) g_grid.state = WAIT_CLICK; // Complete label selected
+
+    Surface surface;
+    if (!EnsureSurface(surface, W, H)) return 1;
+    RECT area = { 0, 0, W, H };
+    FrameRequest req;
+    BuildFrameRequest(req, area);
+    req.frame = area; // Always the full screen, so goldens compare 1:1
+    RenderFrame(surface, req);
+    g_frameArena.Reset();
+    bool ok = WriteFrameImage(surface, W, H, outPath);
+    ReleaseSurface(surface);
+    return ok ? 0 : 1;
 }
 
 // Move mouse to cell and prompt for click
 void MoveToAndPrompt(Cell* c) {
-    g_state = WAIT_CLICK; // Set state to wait for click
-    int x = (c->rc.left + c->rc.right) / 2; // Calculate center X
-    int y = (c->rc.top + c->rc.bottom) / 2; // Calculate center Y
-    SetCursorPos(x, y); // Set mouse cursor position
+    SetCursorPos(c->pt.x, c->pt.y); // Set mouse cursor position (cell center or detected target)
+    RecordJump(c->pt); // Most recent history slot
     ShowWindow(g_hGridWnd, SW_SHOW); // Show grid window
     FilterCells(); // Filter cells (shows only selected)
-    LayoutAndDraw(g_hGridWnd, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN)); // Redraw grid
+    if (g_magnifier) { // Lens around the new cursor position, kept live while the prompt is open
+        CaptureLens();
+        SetTimer(g_hGridWnd, LENS_TIMER_ID, LENS_REFRESH_MS, nullptr);
+    }
+    LayoutAndDraw(g_hGridWnd, g_gridRect); // Redraw grid
     InvalidateRect(g_hGridWnd, nullptr, TRUE); // Invalidate window
     UpdateWindow(g_hGridWnd); // Force window update
 }
 
-// Simulate a mouse click
-void SimClick(DWORD flags) {
-    INPUT input = {}; // Input event structure
-    input.type = INPUT_MOUSE; // Event type: mouse
-    input.mi.dwFlags = flags; // Mouse event flags (e.g., left down/up)
-    SendInput(1, &input, sizeof(input)); // Send input event
-}
\ No newline at end of file
+// Append a keyboard event for a virtual key
+static void PushKey(std::vector<INPUT>& out, WORD vk, bool up) {
+    INPUT in = {};
+    in.type = INPUT_KEYBOARD;
+    in.ki.wVk = vk;
+    in.ki.dwFlags = up ? KEYEVENTF_KEYUP : 0;
+    out.push_back(in);
+}
+
+// Append a mouse event (absolute moves use virtual-desktop normalized coordinates)
+static void PushMouse(std::vector<INPUT>& out, DWORD flags, LONG dx = 0, LONG dy = 0, DWORD data = 0) {
+    INPUT in = {};
+    in.type = INPUT_MOUSE;
+    in.mi.dx = dx;
+    in.mi.dy = dy;
+    in.mi.mouseData = data;
+    in.mi.dwFlags = flags;
+    out.push_back(in);
+}
+
+// Append an absolute cursor move to a screen point
+static void PushMoveTo(std::vector<INPUT>& out, POINT pt) {
+    int vx = GetSystemMetrics(SM_XVIRTUALSCREEN), vy = GetSystemMetrics(SM_YVIRTUALSCREEN); // Virtual desktop origin
+    int vw = GetSystemMetrics(SM_CXVIRTUALSCREEN), vh = GetSystemMetrics(SM_CYVIRTUALSCREEN); // Virtual desktop size
+    LONG nx = (LONG)(((long long)(pt.x - vx) * 65535) / (vw > 1 ? vw - 1 : 1)); // Map to 0..65535
+    LONG ny = (LONG)(((long long)(pt.y - vy) * 65535) / (vh > 1 ? vh - 1 : 1));
+    PushMouse(out, MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_VIRTUALDESK, nx, ny);
+}
+
+// Translate planned events (Core/InputPlan.h) into SendInput records
+static void TranslateInput(const InputEvent* ev, size_t n, std::vector<INPUT>& out) {
+    const DWORD downs[] = { MOUSEEVENTF_LEFTDOWN, MOUSEEVENTF_RIGHTDOWN, MOUSEEVENTF_MIDDLEDOWN }; // By ClickButton
+    const DWORD ups[] = { MOUSEEVENTF_LEFTUP, MOUSEEVENTF_RIGHTUP, MOUSEEVENTF_MIDDLEUP };
+    for (size_t i = 0; i < n; ++i) {
+        const InputEvent& e = ev[i];
+        WORD vk = e.modifier == MOD_CONTROL ? VK_CONTROL : e.modifier == MOD_SHIFT ? VK_SHIFT
+                : e.modifier == MOD_ALT ? VK_MENU : VK_LWIN;
+        switch (e.type) {
+        case EV_MOVE:        PushMoveTo(out, e.pt); break;
+        case EV_BUTTON_DOWN: PushMouse(out, downs[e.button]); break;
+        case EV_BUTTON_UP:   PushMouse(out, ups[e.button]); break;
+        case EV_WHEEL:
+            PushMouse(out, e.horizontal ? MOUSEEVENTF_HWHEEL : MOUSEEVENTF_WHEEL, 0, 0,
+                      (DWORD)(e.notches > 0 ? WHEEL_DELTA : -WHEEL_DELTA));
+            break;
+        case EV_KEY_DOWN:    PushKey(out, vk, false); break;
+        case EV_KEY_UP:      PushKey(out, vk, true); break;
+        }
+    }
+}
+
+// Release the modifier keys the user is physically holding, e.g. a hotkey's Win+Shift, so a click
+// synthesized while they are down isn't a Win+Shift+click. A Win key released on its own opens the
+// Start menu, so an unassigned key is tapped first to mark the Win press as used.
+static void ReleaseHeldModifiers(std::vector<INPUT>& out) {
+    const WORD keys[] = { VK_LSHIFT, VK_RSHIFT, VK_LCONTROL, VK_RCONTROL, VK_LMENU, VK_RMENU, VK_LWIN, VK_RWIN };
+    const WORD MASK_KEY = 0xE8; // Unassigned virtual key: no application reacts to it
+    if ((GetAsyncKeyState(VK_LWIN) | GetAsyncKeyState(VK_RWIN)) & 0x8000) {
+        PushKey(out, MASK_KEY, false);
+        PushKey(out, MASK_KEY, true);
+    }
+    for (WORD vk : keys)
+        if (GetAsyncKeyState(vk) & 0x8000) PushKey(out, vk, true);
+}
+
+// Simulate a mouse action: the planned events go out in one SendInput batch per pause, so events
+// with no pause between them are delivered atomically. Only drags pause (about 0.2 s in all).
+// With 'releaseHeld', held modifiers are released at the start of the first batch.
+void SimClick(const InputAction& action, bool releaseHeld) {
+    std::vector<InputEvent> plan; // Planned input events
+    PlanInput(action, plan);
+    std::vector<INPUT> batch;
+    for (size_t i = 0, j; i < plan.size(); i = j) {
+        if (plan[i].delayMs) Sleep(plan[i].delayMs);
+        for (j = i + 1; j < plan.size() && !plan[j].delayMs; ++j) {} // Up to the next pause
+        batch.clear();
+        if (i == 0 && releaseHeld) ReleaseHeldModifiers(batch);
+        TranslateInput(&plan[i], j - i, batch);
+        SendInput((UINT)batch.size(), batch.data(), sizeof(INPUT)); // Delivered atomically, no interleaving
+    }
+}
+
+// --- Jump history ---
+
+// Move entry 'from' to the front, shifting the ones before it down a slot
+static void PromoteJump(int from) {
+    JumpRecord r = g_history[from];
+    for (int i = from; i > 0; --i) g_history[i] = g_history[i - 1];
+    g_history[0] = r;
+}
+
+// Put a jump target at the front of the history. A target already listed moves up and keeps its
+// action until a new one is taken; otherwise the oldest entry drops out.
+void RecordJump(POINT pt) {
+    int i = 0;
+    while (i < g_historyCount && (g_history[i].pt.x != pt.x || g_history[i].pt.y != pt.y)) ++i;
+    if (i == g_historyCount) { // New target
+        if (g_historyCount < HISTORY_SIZE) ++g_historyCount;
+        i = g_historyCount - 1; // Last slot (the oldest, when full) is reused
+        g_history[i] = JumpRecord();
+        g_history[i].pt = pt;
+    }
+    PromoteJump(i);
+    g_historyDirty = true; // Written with the action that follows, or at exit
+}
+
+// Remember the action taken at the latest jump, at the cursor's final position (arrow nudges count)
+void RecordJumpAction(const InputAction& action) {
+    if (g_historyCount == 0) return;
+    GetCursorPos(&g_history[0].pt);
+    g_history[0].hasAction = true;
+    g_history[0].action = action;
+    MarkHistoryDirty();
+}
+
+// Jump to a history slot and repeat its action as one input batch. Nothing is shown or drawn; an
+// open grid is dismissed first. Runs while the hotkey's modifiers are still held, so the batch
+// releases them first: the replayed action must be a plain click, as it was recorded.
+void ReplayJump(HWND hWnd, int slot) {
+    if (slot >= g_historyCount) return;
+    if (g_grid.state != HIDDEN) HideGrid(hWnd);
+    const JumpRecord& r = g_history[slot];
+    if (r.hasAction) {
+        InputAction a = r.action;
+        a.moveFirst = true; // Move and act in the same batch
+        a.at = r.pt;
+        SimClick(a, true);
+    } else {
+        SetCursorPos(r.pt.x, r.pt.y);
+    }
+    PromoteJump(slot); // Most recently used
+    MarkHistoryDirty();
+}
+
+// Restart the write timer: a burst of jumps and replays costs one file write, off the input path
+static void MarkHistoryDirty() {
+    g_historyDirty = true;
+    SetTimer(g_hGridWnd, HISTORY_TIMER_ID, HISTORY_SAVE_MS, nullptr); // Same ID: resets the countdown
+}
+
+// History file: "VJMP", version, count, then per entry x, y, action kind (-1 = move only), button,
+// clicks and notches, all little-endian int32
+static const char HISTORY_MAGIC[4] = { 'V', 'J', 'M', 'P' };
+const int HISTORY_FIELDS = 6; // int32 values per entry
+
+// Read Settings\VimerateHistory.bin; a missing or malformed file leaves the history empty
+void LoadHistory() {
+    std::string data;
+    g_historyCount = 0;
+    if (!ReadFileBytes(g_settingsDir + L"\\VimerateHistory.bin", data) || data.size() < 12) return;
+    uint32_t version, count;
+    memcpy(&version, data.data() + 4, 4);
+    memcpy(&count, data.data() + 8, 4);
+    if (memcmp(data.data(), HISTORY_MAGIC, 4) != 0 || version != HISTORY_VERSION || count > (uint32_t)HISTORY_SIZE ||
+        data.size() != 12 + (size_t)count * HISTORY_FIELDS * 4) return;
+    for (uint32_t i = 0; i < count; ++i) {
+        int32_t f[HISTORY_FIELDS];
+        memcpy(f, data.data() + 12 + (size_t)i * sizeof(f), sizeof(f));
+        JumpRecord r;
+        r.pt = { f[0], f[1] };
+        if (f[2] == ACT_CLICK || f[2] == ACT_SCROLL) { // Drags are never recorded
+            r.hasAction = true;
+            r.action.kind = (ActionKind)f[2];
+            r.action.button = (ClickButton)std::max(0, std::min((int)f[3], (int)BTN_MIDDLE));
+            r.action.clicks = std::max(1, std::min((int)f[4], 2));
+            r.action.notches = f[5];
+        }
+        g_history[g_historyCount++] = r;
+    }
+}
+
+// Write the whole history (a few hundred bytes); called from the debounce timer and at exit
+void SaveHistory() {
+    g_historyDirty = false;
+    BYTE data[12 + HISTORY_SIZE * HISTORY_FIELDS * 4];
+    uint32_t count = (uint32_t)g_historyCount;
+    memcpy(data, HISTORY_MAGIC, 4);
+    memcpy(data + 4, &HISTORY_VERSION, 4);
+    memcpy(data + 8, &count, 4);
+    for (int i = 0; i < g_historyCount; ++i) {
+        const JumpRecord& r = g_history[i];
+        int32_t f[HISTORY_FIELDS] = { r.pt.x, r.pt.y, r.hasAction ? (int32_t)r.action.kind : -1,
+                                      (int32_t)r.action.button, r.action.clicks, r.action.notches };
+        memcpy(data + 12 + (size_t)i * sizeof(f), f, sizeof(f));
+    }
+    WriteFileBytes(g_settingsDir + L"\\VimerateHistory.bin", data, 12 + (size_t)count * HISTORY_FIELDS * 4);
+}
+
+// --- Session telemetry ---
+
+// Milliseconds since StartTelemetry (wraps after 49 days; the analyzer only takes differences)
+static uint32_t TelemetryNow() {
+    return (uint32_t)(GetTickCount64() - g_telemetry.startMs);
+}
+
+// TACT_* for a click, scroll or drag
+uint16_t TelemetryActionCode(const InputAction& action) {
+    if (action.kind == ACT_SCROLL) return TACT_SCROLL;
+    if (action.kind == ACT_DRAG) return TACT_DRAG;
+    if (action.clicks == 2) return TACT_DOUBLE;
+    return action.button == BTN_RIGHT ? TACT_RIGHT : action.button == BTN_MIDDLE ? TACT_MIDDLE : TACT_LEFT;
+}
+
+// UI thread: queue one record. Never waits and never allocates; a full ring drops the record.
+void LogEvent(uint8_t type, uint16_t arg, uint32_t a, uint32_t b) {
+    if (!g_telemetry.thread) return; // Telemetry off
+    ULONG head = (ULONG)g_telemetry.head; // Only this thread writes head
+    ULONG used = head - (ULONG)g_telemetry.tail;
+    if (used >= TELEMETRY_RING) { InterlockedIncrement(&g_telemetry.dropped); return; }
+    TelemetryRecord& r = g_telemetry.ring[head & (TELEMETRY_RING - 1)];
+    r.ms = TelemetryNow();
+    r.type = type;
+    r.pad = 0;
+    r.arg = arg;
+    r.a = a;
+    r.b = b;
+    InterlockedExchange(&g_telemetry.head, (LONG)(head + 1)); // Full barrier: the record is complete before it is published
+    if (used + 1 == TELEMETRY_RING / 2) SetEvent(g_telemetry.wake); // Filling fast: flush early
+}
+
+// Flush thread: every TELEMETRY_FLUSH_MS, or sooner when woken, copy the published records out of
+// the ring, free their slots and append them with a single write
+static DWORD WINAPI TelemetryThreadMain(LPVOID) {
+    static TelemetryRecord batch[TELEMETRY_RING + 1]; // Ring contents plus a drop count
+    for (;;) {
+        WaitForSingleObject(g_telemetry.wake, TELEMETRY_FLUSH_MS);
+        bool last = g_telemetry.quit; // Set only after the UI thread logged its last record
+        size_t n = 0;
+        LONG dropped = InterlockedExchange(&g_telemetry.dropped, 0);
+        if (dropped) batch[n++] = { TelemetryNow(), TEL_DROPPED, 0, 0, (uint32_t)dropped, 0 };
+        ULONG head = (ULONG)InterlockedCompareExchange(&g_telemetry.head, 0, 0); // Acquire the published records
+        ULONG tail = (ULONG)g_telemetry.tail;
+        for (; tail != head; ++tail) batch[n++] = g_telemetry.ring[tail & (TELEMETRY_RING - 1)];
+        InterlockedExchange(&g_telemetry.tail, (LONG)tail); // Slots may be reused from here on
+        DWORD written;
+        if (n) WriteFile(g_telemetry.file, batch, (DWORD)(n * sizeof(TelemetryRecord)), &written, nullptr);
+        if (last) return 0;
+    }
+}
+
+// Open Settings\VimerateTelemetry.bin for appending (header on a new file) and start the flush thread
+void StartTelemetry() {
+    static_assert(sizeof(TelemetryRecord) == 16, "telemetry record layout is part of the file format");
+    HANDLE f = CreateFileW((g_settingsDir + L"\\VimerateTelemetry.bin").c_str(), GENERIC_WRITE, FILE_SHARE_READ,
+                           nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return;
+    LARGE_INTEGER size = {};
+    GetFileSizeEx(f, &size);
+    if (size.QuadPart % sizeof(TelemetryRecord)) { // Torn write at a crash: drop the partial record
+        size.QuadPart -= size.QuadPart % sizeof(TelemetryRecord);
+        SetFilePointerEx(f, size, nullptr, FILE_BEGIN);
+        SetEndOfFile(f);
+    }
+    LARGE_INTEGER zero = {};
+    SetFilePointerEx(f, zero, nullptr, FILE_END); // Only the flush thread writes from here, so writes stay appends
+    DWORD written;
+    if (size.QuadPart == 0) { // Header: magic, version, record size, reserved
+        uint32_t header[4] = { 0, TELEMETRY_VERSION, (uint32_t)sizeof(TelemetryRecord), 0 };
+        memcpy(header, "VTEL", 4);
+        WriteFile(f, header, sizeof(header), &written, nullptr);
+    }
+
+    g_telemetry.file = f;
+    g_telemetry.startMs = GetTickCount64();
+    g_telemetry.wake = CreateEventW(nullptr, FALSE, FALSE, nullptr); // Auto-reset
+    if (g_telemetry.wake) g_telemetry.thread = CreateThread(nullptr, 0, TelemetryThreadMain, nullptr, 0, nullptr);
+    if (!g_telemetry.thread) { StopTelemetry(); return; }
+
+    FILETIME ft; // Wall clock, so sessions can be told apart and dated
+    GetSystemTimeAsFileTime(&ft);
+    uint64_t unixTime = ((uint64_t)ft.dwHighDateTime << 32 | ft.dwLowDateTime) / 10000000 - 11644473600ULL;
+    LogEvent(TEL_SESSION, (uint16_t)TELEMETRY_VERSION, (uint32_t)unixTime, (uint32_t)(unixTime >> 32));
+}
+
+// Final flush and cleanup; the UI thread must be done logging
+void StopTelemetry() {
+    if (g_telemetry.thread) {
+        g_telemetry.quit = true;
+        SetEvent(g_telemetry.wake);
+        WaitForSingleObject(g_telemetry.thread, INFINITE);
+        CloseHandle(g_telemetry.thread);
+        g_telemetry.thread = nullptr;
+    }
+    if (g_telemetry.wake) CloseHandle(g_telemetry.wake);
+    if (g_telemetry.file != INVALID_HANDLE_VALUE) CloseHandle(g_telemetry.file);
+    g_telemetry.wake = nullptr;
+    g_telemetry.file = INVALID_HANDLE_VALUE;
+}
+
+// --- Benchmark suite ---
+
+// One timed scenario: median and minimum over the measured iterations
+// Read a previous --bench report to compare against
+static bool LoadBenchBaseline(const std::wstring& path, std::vector<BenchResult>& out) {
+    std::string text;
+    if (!ReadFileBytes(path, text)) return false;
+    ParseBenchBaseline(text, out);
+    return true;
+}
+
+// --bench <out.json> [--baseline base.json] [--threshold PERCENT] [--min-delta US] [--iterations N]
+// Sweeps pool sizes, resolutions and typing scenarios through GenerateCells, FilterCells,
+// LayoutCells and RenderFrame. With a baseline, exits with 1 if any scenario's median grew
+// by more than the threshold (default 10%) and by more than the minimum delta (default 5 us).
+// The portable scenarios (kernels, grid, label rasterization) also run in Tools/VimerateBench.cpp.
+int RunBenchCommand(int argc, wchar_t** argv) {
+    if (argc < 3) return 2; // Output path is required
+    std::wstring outPath = argv[2], baselinePath;
+    double threshold = BENCH_THRESHOLD_PCT; // Allowed slowdown in percent
+    double minDelta = BENCH_MIN_DELTA_US; // ... and in microseconds
+    int iterations = BENCH_ITERATIONS; // Timed samples per scenario
+
+    for (int i = 3; i + 1 < argc; i += 2) { // Option/value pairs
+        std::wstring opt = argv[i];
+        if (opt == L"--baseline") baselinePath = argv[i + 1];
+        else if (opt == L"--threshold") threshold = _wtof(argv[i + 1]);
+        else if (opt == L"--min-delta") minDelta = _wtof(argv[i + 1]);
+        else if (opt == L"--iterations") iterations = std::max(1, _wtoi(argv[i + 1]));
+        else return 2; // Unknown option
+    }
+
+    const int pools[] = { 6, 12, 18, 24, 30, 36 }; // Pool sizes (36 is the full alphabet)
+    const struct { const char* name; int w, h; } screens[] = {
+        { "1080p", 1920, 1080 }, { "1440p", 2560, 1440 }, { "4k", 3840, 2160 },
+        { "8k", 7680, 4320 }, { "3x1080p", 5760, 1080 } // Last one: multi-monitor virtual desktop
+    };
+    const struct { const char* name; const wchar_t* typed; } scenarios[] = {
+        { "show_all", L"" }, { "prefix", L"a" }, { "dotted_prefix", L"a." }, { "wait_click", L"aj" }
+    };
+
+    std::vector<BenchResult> results;
+    for (int pool : pools) {
+        g_poolSize = pool;
+        std::string p = "/pool" + std::to_string(pool);
+        results.push_back(BenchRun("generate" + p, iterations, [] { GenerateCells(g_poolSize); }));
+        g_grid.state = SHOW_ALL;
+        g_grid.typed.clear();
+        results.push_back(BenchRun("filter/show_all" + p, iterations, [] { FilterCells(); }));
+        g_grid.typed = L"a"; // First key: one row's labels
+        results.push_back(BenchRun("filter/prefix" + p, iterations, [] { FilterCells(); }));
+        g_grid.typed = L"a."; // Into the dotted labels
+        results.push_back(BenchRun("filter/dotted_prefix" + p, iterations, [] { FilterCells(); }));
+
+        for (const auto& scr : screens) {
+            std::string r = p + "/" + scr.name;
+            RECT area = { 0, 0, scr.w, scr.h };
+            results.push_back(BenchRun("layout" + r, iterations, [&] { LayoutCells(area); }));
+            g_foveated = true; // Same cells, non-uniform edges around an off-center focus
+            g_focus = { scr.w / 3, scr.h / 3 };
+            results.push_back(BenchRun("layout_foveated" + r, iterations, [&] { LayoutCells(area); }));
+            g_foveated = false;
+
+            Surface surface;
+            FrameRequest req; // Reused across iterations, like the UI thread's request slots
+            if (!EnsureSurface(surface, scr.w, scr.h)) continue; // Out of memory at this size
+            for (const auto& sc : scenarios) {
+                g_grid.typed = sc.typed;
+                g_grid.state = SHOW_ALL; // Typing state: only the cells matching the prefix ...
+                FilterCells();
+                if (g_filtered.size() == 1 && g_filtered[0]->lbl == g_grid.typed) // ... or the click prompt for a complete label
+                    g_grid.state = WAIT_CLICK;
+                results.push_back(BenchRun(std::string("render/") + sc.name + r, iterations,
+                                           [&] {
+                                               BuildFrameRequest(req, area);
+                                               RenderFrame(surface, req);
+                                               g_frameArena.Reset();
+                                           }));
+            }
+            ReleaseSurface(surface);
+        }
+    }
+
+    // Governor levels: the full 4K grid at each quality
+    {
+        g_poolSize = DEFAULT_POOL_SIZE;
+        GenerateCells(g_poolSize);
+        g_grid.typed.clear();
+        g_grid.state = SHOW_ALL;
+        FilterCells();
+        Surface surface;
+        FrameRequest req;
+        RECT area = { 0, 0, 3840, 2160 };
+        if (EnsureSurface(surface, 3840, 2160)) {
+            for (int q = 0; q < QUALITY_LEVELS; ++q) {
+                g_quality = q;
+                results.push_back(BenchRun(std::string("render_quality/") + QUALITY_NAMES[q] + "/4k", iterations, [&] {
+                    BuildFrameRequest(req, area);
+                    RenderFrame(surface, req);
+                    g_frameArena.Reset();
+                }));
+            }
+            g_quality = QUALITY_FULL;
+            ReleaseSurface(surface);
+        }
+    }
+
+    // Cold-start cost the label atlas file saves (its scratch copy is discarded)
+    std::vector<BYTE> atlasFile;
+    results.push_back(BenchRun("atlas/build", 1, [&] { BuildLabelAtlas(ScreenDpi(), atlasFile); }));
+    atlasFile = std::vector<BYTE>();
+
+    // Target detection on a synthetic desktop at every screen size
+    std::vector<BYTE> desktop;
+    std::vector<RECT> found;
+    for (const auto& scr : screens) {
+        SyntheticDesktop(desktop, scr.w, scr.h);
+        results.push_back(BenchRun(std::string("targets/") + scr.name, iterations,
+                                   [&] { DetectTargets(g_analysis, desktop.data(), scr.w * 4, scr.w, scr.h, found); }));
+    }
+
+    // Per-cell contrast statistics over the 4K desktop at the full pool
+    g_poolSize = DEFAULT_POOL_SIZE;
+    GenerateCells(g_poolSize);
+    SyntheticDesktop(desktop, 3840, 2160);
+    RECT desk = { 0, 0, 3840, 2160 };
+    AnalyzeImage(g_analysis, desktop.data(), 3840 * 4, 3840, 2160, desk);
+    g_contrastDirty = true;
+    LayoutCells(desk);
+    results.push_back(BenchRun("contrast/4k", iterations, [] { ApplyCellContrast(); }));
+
+    // Magnifier kernels: a quarter-size desktop scaled up to fill 4K, far more than any lens
+    {
+        std::vector<BYTE> scaled((size_t)3840 * 2160 * 4);
+        std::vector<uint16_t> rows((size_t)3840 * 8);
+        std::vector<BYTE> quarter((size_t)960 * 540 * 4);
+        for (int y = 0; y < 540; ++y) memcpy(&quarter[(size_t)y * 960 * 4], &desktop[(size_t)y * 3840 * 4], (size_t)960 * 4);
+        results.push_back(BenchRun("lens/nearest_x4/4k", iterations, [&] {
+            ScaleNearestBGRA(quarter.data(), 960 * 4, 960, 540, 4, scaled.data(), 3840 * 4, 3840, 2160); }));
+        results.push_back(BenchRun("lens/bilinear_x4/4k", iterations, [&] {
+            ScaleBilinearBGRA(quarter.data(), 960 * 4, 960, 540, 4, scaled.data(), 3840 * 4, 3840, 2160, rows.data()); }));
+    }
+    desktop = std::vector<BYTE>(); // Fixtures are large: give the memory back
+
+    // Steady-state typing must not touch the heap: type and erase a prefix and count allocations
+    LONG keystrokeAllocs = 0;
+    {
+        g_poolSize = DEFAULT_POOL_SIZE;
+        GenerateCells(g_poolSize);
+        Surface surface;
+        if (EnsureSurface(surface, 1920, 1080)) {
+            RECT area = { 0, 0, 1920, 1080 };
+            FrameRequest req;
+            auto keystroke = [&] {
+                FilterCells();
+                BuildFrameRequest(req, area);
+                RenderFrame(surface, req);
+                g_frameArena.Reset();
+            };
+            g_grid.state = SHOW_ALL;
+            for (int round = 0; round < 12; ++round) {
+                if (round == 2) keystrokeAllocs = g_allocCount; // First rounds warm up capacities
+                g_grid.typed.clear(); keystroke();
+                g_grid.typed += L'a'; keystroke();
+                g_grid.typed += L'.'; keystroke();
+                g_grid.typed.pop_back(); keystroke();
+            }
+            keystrokeAllocs = g_allocCount - keystrokeAllocs;
+            ReleaseSurface(surface);
+        }
+    }
+
+    std::vector<BenchResult> baseline; // Previous report to compare against
+    bool haveBaseline = !baselinePath.empty() && LoadBenchBaseline(baselinePath, baseline);
+    if (!baselinePath.empty() && !haveBaseline) return 2; // Asked to compare but can't read baseline
+
+    int regressions = 0;
+    std::string text = BenchReport(results, baseline, iterations, threshold, minDelta,
+                                   { { "keystroke_allocations", (long)keystrokeAllocs } }, regressions);
+    if (!WriteFileBytes(outPath, text.data(), text.size())) return 2;
+    return (regressions > 0 || keystrokeAllocs > 0) ? 1 : 0; // Allocations while typing fail the run too
+}
+
+// --- Local command pipe ---
+
+// Pipe commands (Core/Commands.h) always resolve on the uniform full-screen grid, the one the
+// overlay shows with its default settings: they ignore FoveatedLayout, SmartTargets and the window
+// hotkey's area, so a script gets the same coordinates for a label wherever the cursor is and
+// whatever is on screen. Moves and actions run on the pipe thread, as SendInput allows.
+static void PipeMove(POINT pt) { SetCursorPos(pt.x, pt.y); }
+static void PipePerform(const InputAction& action) { SimClick(action); }
+static const CommandActions PIPE_ACTIONS = { PipeMove, PipePerform };
+
+// Serve one connected client: read newline-separated commands, answer each batch with one write
+static void ServeCommandClient(HANDLE pipe) {
+    std::string pending, reply; // Unfinished input line, replies for the current batch
+    char buf[16384];
+    DWORD read = 0;
+    while (ReadFile(pipe, buf, sizeof(buf), &read, nullptr) && read > 0) {
+        pending.append(buf, read);
+        int poolSize = (int)InterlockedCompareExchange(&g_pipePoolSize, 0, 0); // One snapshot per batch
+        ExecuteCommandBatch(pending, poolSize, ScreenRect(), PIPE_ACTIONS, reply);
+        if (!reply.empty()) {
+            DWORD written = 0;
+            if (!WriteFile(pipe, reply.data(), (DWORD)reply.size(), &written, nullptr)) break;
+            reply.clear();
+        }
+    }
+}
+
+// Accept clients one after another for the lifetime of the process
+static DWORD WINAPI CommandPipeMain(LPVOID) {
+    for (;;) {
+        HANDLE pipe = CreateNamedPipeW(COMMAND_PIPE_NAME, PIPE_ACCESS_DUPLEX | FILE_FLAG_FIRST_PIPE_INSTANCE, // Fail if another process owns the name
+                                       PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                                       1, 65536, 65536, 0, nullptr); // Local clients only
+        if (pipe == INVALID_HANDLE_VALUE) {
+            OutputDebugStringW(L"Vimerate: command pipe unavailable (name already in use?)\n");
+            return 1;
+        }
+        if (ConnectNamedPipe(pipe, nullptr) || GetLastError() == ERROR_PIPE_CONNECTED)
+            ServeCommandClient(pipe);
+        DisconnectNamedPipe(pipe);
+        CloseHandle(pipe);
+    }
+}
+
+// Start the command server thread (ends with the process)
+void StartCommandPipe() {
+    HANDLE t = CreateThread(nullptr, 0, CommandPipeMain, nullptr, 0, nullptr);
+    if (t) CloseHandle(t);
+}
@@ -0,0 +1,637 @@
+// VimerateX11: the Vimerate grid on X11 desktops. It shares the grid model, key handling, font,
+// compositing and input plans with the Win32 app (Core/), and adds the X11 pieces:
+//   - an override-redirect window with a 32-bit ARGB visual and an empty input shape, so pointer
+//     input goes through to whatever is under the grid
+//   - frames drawn into a MIT-SHM image and shown with XShmPutImage: pixels don't travel over
+//     the X connection, but the server still copies the changed area into the window. Without
+//     MIT-SHM (a remote display), frames go over the connection with XPutImage.
+//   - XTest for cursor moves, clicks, scrolls and drags. libXtst is loaded at run time; without
+//     it, jumps still move the cursor (XWarpPointer) but mouse actions are unavailable.
+//   - a global hotkey grabbed on the root window: Super+Shift+Z, the Windows default
+// With a compositing manager the label boxes are blended over the desktop; without one the window
+// is shaped to the boxes, so the rest of the screen stays visible. With --command-socket, the Win32
+// command pipe's protocol (Core/Commands.h) is served on a Unix socket. Smart targets, adaptive
+// contrast, the magnifier, jump history and telemetry are Win32 only.
+//
+//   cmake -S . -B build && cmake --build build
+//   ./build/vimerate-x11 [--pool N] [--foveated] [--command-socket]
+//   ./build/vimerate-x11 --self-test   (opens the grid, types a label with XTest, checks the jump)
+
+#include "Core/Grid.h"    // Labels, geometry and key handling shared with the Win32 app
+#include "Core/Commands.h" // Command protocol shared with the Win32 pipe
+#include "Core/Kernels.h" // BlitCoverage
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>    // XMatchVisualInfo, XLookupString
+#include <X11/keysym.h>
+#include <X11/extensions/XShm.h>   // MIT-SHM presentation
+#include <X11/extensions/shape.h>  // Input pass-through and shaping without a compositor
+#include <dlfcn.h>        // dlopen for libXtst
+#include <sys/ipc.h>
+#include <sys/select.h>   // Waiting for events with a timeout
+#include <sys/shm.h>
+#include <sys/socket.h>   // Command socket
+#include <sys/stat.h>     // umask
+#include <sys/un.h>       // sockaddr_un
+#include <unistd.h>       // usleep, read, close
+#include <chrono>         // Self-test deadlines
+#include <cstdio>         // fprintf
+#include <cstdlib>        // atoi, calloc, getenv
+#include <cstring>        // memset, strcmp
+
+const uint32_t CELL_COLOR = 0x80ADD8E6;   // Label boxes: semi-transparent light blue, as on Windows
+const uint32_t TEXT_COLOR = 0xFF000000;   // Black label text
+const uint32_t PROMPT_COLOR = 0xFFADD8E6; // Opaque light blue prompt box
+const unsigned HOTKEY_MODS = Mod4Mask | ShiftMask; // Super+Shift+Z
+const KeySym   HOTKEY_KEY = XK_z;
+const unsigned MODIFIER_MASK = ShiftMask | ControlMask | Mod1Mask | Mod4Mask; // Lock keys don't matter
+
+// Grid cell: label, label box area and jump target
+struct Cell { std::wstring lbl; RECT rc; POINT pt; };
+
+Display*  g_dpy = nullptr;
+Window    g_root = 0, g_win = 0;
+GC        g_gc = nullptr;
+int       g_w = 0, g_h = 0;                // Screen size: the grid covers the whole screen
+XImage*   g_image = nullptr;               // Frame buffer: premultiplied BGRA, like the Win32 DIB section
+XShmSegmentInfo g_shm = {};
+bool      g_useShm = false;                // Present with XShmPutImage (else XPutImage)
+bool      g_composited = false;            // A compositing manager blends the window
+KeyCode   g_hotkeyCode = 0;
+
+GridSession        g_grid;                 // Grid state, typed input and pending drag
+int                g_poolSize = (int)POOL.length();
+bool               g_foveated = false;     // Shrink cells around the cursor
+std::vector<Cell>  g_cells;                // All grid cells, Core/Grid.h order
+std::vector<Cell*> g_filtered;             // Cells matching the typed input
+std::vector<LONG>  g_rowEdges, g_colEdges; // Current layout
+RECT               g_drawn = { 0, 0, 0, 0 }; // Area the last frame drew, cleared by the next
+
+// Labels pre-rendered at startup, like the Win32 atlas but in memory: one tile of interleaved
+// (box, text) coverage per label of the full-pool grid
+int                  g_fontScale = 2;
+int                  g_tileW = 0, g_tileH = 0;
+std::vector<uint8_t> g_tiles;
+std::vector<int>     g_boxW;               // Box width per tile (the height is the same for all)
+
+// XTest entry points, resolved from libXtst at run time
+struct XTestApi {
+    int (*motion)(Display*, int, int, int, unsigned long) = nullptr;
+    int (*button)(Display*, unsigned int, Bool, unsigned long) = nullptr;
+    int (*key)(Display*, unsigned int, Bool, unsigned long) = nullptr;
+} g_xtest;
+
+// --- Setup ---
+
+static void LoadXTest() {
+    void* lib = dlopen("libXtst.so.6", RTLD_NOW | RTLD_LOCAL);
+    if (!lib) lib = dlopen("libXtst.so", RTLD_NOW | RTLD_LOCAL);
+    if (!lib) return;
+    g_xtest.motion = (decltype(g_xtest.motion))dlsym(lib, "XTestFakeMotionEvent");
+    g_xtest.button = (decltype(g_xtest.button))dlsym(lib, "XTestFakeButtonEvent");
+    g_xtest.key = (decltype(g_xtest.key))dlsym(lib, "XTestFakeKeyEvent");
+    if (!g_xtest.motion || !g_xtest.button || !g_xtest.key) g_xtest = XTestApi();
+}
+
+// Errors from requests made while this is installed are recorded instead of ending the process
+static int g_xError = 0;
+static int RecordXError(Display*, XErrorEvent* e) { g_xError = e->error_code; return 0; }
+
+// Screen DPI: Xft.dpi when the desktop sets it, else the physical size the server reports
+static unsigned ScreenDpi() {
+    if (const char* rm = XResourceManagerString(g_dpy))
+        if (const char* p = strstr(rm, "Xft.dpi:")) {
+            int dpi = atoi(p + 8);
+            if (dpi > 0) return (unsigned)dpi;
+        }
+    int mm = DisplayWidthMM(g_dpy, DefaultScreen(g_dpy));
+    return mm > 0 ? (unsigned)(g_w * 254 / (mm * 10)) : 96;
+}
+
+// Shared-memory frame buffer; false if the server can't attach it (e.g. a remote display)
+static bool CreateShmImage(Visual* visual) {
+    if (!XShmQueryExtension(g_dpy)) return false;
+    g_image = XShmCreateImage(g_dpy, visual, 32, ZPixmap, nullptr, &g_shm, g_w, g_h);
+    if (!g_image) return false;
+    g_shm.shmid = shmget(IPC_PRIVATE, (size_t)g_image->bytes_per_line * g_h, IPC_CREAT | 0600);
+    if (g_shm.shmid >= 0) g_shm.shmaddr = g_image->data = (char*)shmat(g_shm.shmid, nullptr, 0);
+    bool ok = g_shm.shmid >= 0 && g_shm.shmaddr != (char*)-1;
+    if (ok) {
+        g_shm.readOnly = False;
+        g_xError = 0;
+        XErrorHandler old = XSetErrorHandler(RecordXError);
+        XShmAttach(g_dpy, &g_shm);
+        XSync(g_dpy, False); // The attach error, if any, arrives here
+        XSetErrorHandler(old);
+        ok = g_xError == 0;
+    }
+    if (g_shm.shmid >= 0) shmctl(g_shm.shmid, IPC_RMID, nullptr); // Freed once both sides detach
+    if (!ok) {
+        if (g_shm.shmaddr && g_shm.shmaddr != (char*)-1) shmdt(g_shm.shmaddr);
+        g_image->data = nullptr;
+        XDestroyImage(g_image);
+        g_image = nullptr;
+    }
+    return ok;
+}
+
+// Full-screen override-redirect ARGB window and its frame buffer
+static bool CreateOverlay() {
+    int screen = DefaultScreen(g_dpy);
+    g_root = RootWindow(g_dpy, screen);
+    g_w = DisplayWidth(g_dpy, screen);
+    g_h = DisplayHeight(g_dpy, screen);
+    XVisualInfo vi;
+    if (!XMatchVisualInfo(g_dpy, screen, 32, TrueColor, &vi)) {
+        fprintf(stderr, "Vimerate: the X server has no 32-bit ARGB visual\n");
+        return false;
+    }
+    XSetWindowAttributes attrs = {};
+    attrs.override_redirect = True; // No window manager decoration or placement
+    attrs.colormap = XCreateColormap(g_dpy, g_root, vi.visual, AllocNone);
+    attrs.background_pixel = 0; // Transparent until the first frame
+    attrs.border_pixel = 0;
+    attrs.event_mask = KeyPressMask | ExposureMask;
+    g_win = XCreateWindow(g_dpy, g_root, 0, 0, g_w, g_h, 0, 32, InputOutput, vi.visual,
+                          CWOverrideRedirect | CWColormap | CWBackPixel | CWBorderPixel | CWEventMask, &attrs);
+    XShapeCombineRectangles(g_dpy, g_win, ShapeInput, 0, 0, nullptr, 0, ShapeSet, Unsorted); // Clicks go through
+    g_gc = XCreateGC(g_dpy, g_win, 0, nullptr);
+
+    char cm[32];
+    snprintf(cm, sizeof(cm), "_NET_WM_CM_S%d", screen); // Owned by the running compositing manager
+    g_composited = XGetSelectionOwner(g_dpy, XInternAtom(g_dpy, cm, False)) != 0;
+
+    g_useShm = CreateShmImage(vi.visual);
+    if (!g_useShm) {
+        g_image = XCreateImage(g_dpy, vi.visual, 32, ZPixmap, 0, (char*)calloc((size_t)g_w * g_h, 4), g_w, g_h, 32, 0);
+        if (!g_image || !g_image->data) return false;
+    }
+    g_image->byte_order = LSBFirst; // BGRA in memory, as the shared kernels expect
+    memset(g_image->data, 0, (size_t)g_image->bytes_per_line * g_h);
+    return true;
+}
+
+// Tile of a cell of the current grid: (first * alphabet + last) * 2 + dotted, as on Windows
+static size_t TileIndex(size_t cell) {
+    size_t first = cell / 2 / g_poolSize, last = cell / 2 % g_poolSize;
+    return (first * POOL.length() + last) * 2 + (cell & 1);
+}
+
+// Rasterize every label of the full-pool grid once
+static void BuildTiles() {
+    g_fontScale = FontScale(ScreenDpi());
+    size_t labels = GridCellCount((int)POOL.length());
+    wchar_t lbl[4];
+    g_boxW.resize(labels);
+    g_tileW = 0;
+    for (size_t i = 0; i < labels; ++i) {
+        CellLabel(i, (int)POOL.length(), lbl);
+        g_boxW[i] = LabelBoxWidth(lbl, g_fontScale);
+        g_tileW = std::max(g_tileW, g_boxW[i]);
+    }
+    g_tileH = LabelBoxHeight(g_fontScale);
+    g_tiles.assign(labels * g_tileW * g_tileH * 2, 0);
+    for (size_t i = 0; i < labels; ++i) {
+        CellLabel(i, (int)POOL.length(), lbl);
+        RasterizeLabel(lbl, g_fontScale, &g_tiles[i * g_tileW * g_tileH * 2], g_tileW * 2);
+    }
+}
+
+static void GenerateCells() {
+    size_t count = GridCellCount(g_poolSize);
+    g_cells.assign(count, Cell());
+    wchar_t lbl[4];
+    for (size_t i = 0; i < count; ++i) {
+        int n = CellLabel(i, g_poolSize, lbl);
+        g_cells[i].lbl.assign(lbl, n);
+    }
+    g_filtered.reserve(count);
+}
+
+// --- Grid ---
+
+static void FilterCells() {
+    FilterByPrefix(g_cells, g_grid.typed, g_filtered);
+}
+
+static void LayoutCells(const POINT* focus) {
+    LayoutGrid(g_cells, { 0, 0, g_w, g_h }, g_poolSize, focus, g_rowEdges, g_colEdges);
+}
+
+// Top-left of a cell's label box: centered in the cell
+static POINT BoxOrigin(const Cell& c) {
+    int bw = g_boxW[TileIndex((size_t)(&c - g_cells.data()))];
+    return { c.rc.left + (c.rc.right - c.rc.left - bw) / 2, c.rc.top + (c.rc.bottom - c.rc.top - g_tileH) / 2 };
+}
+
+static bool HasPrompt() { return g_grid.state == WAIT_CLICK && g_filtered.size() == 1; }
+
+// Draw the current state and show the part of the window that changed: the previous frame's area
+// is cleared, the new labels are composited, and the union of both is presented
+static void Present() {
+    uint8_t* bits = (uint8_t*)g_image->data;
+    int stride = g_image->bytes_per_line;
+    for (LONG y = g_drawn.top; y < g_drawn.bottom; ++y)
+        memset(bits + (size_t)y * stride + (size_t)g_drawn.left * 4, 0, (size_t)(g_drawn.right - g_drawn.left) * 4);
+
+    RECT box = { g_w, g_h, 0, 0 }; // Empty until something is drawn
+    std::vector<XRectangle> shape; // Drawn boxes, for the window shape without a compositor
+    auto add = [&](LONG x, LONG y, int w, int h) {
+        box.left = std::min(box.left, x); box.top = std::min(box.top, y);
+        box.right = std::max(box.right, x + w); box.bottom = std::max(box.bottom, y + h);
+        if (!g_composited) shape.push_back({ (short)x, (short)y, (unsigned short)w, (unsigned short)h });
+    };
+    if (g_grid.state != HIDDEN) {
+        for (Cell* c : g_filtered) {
+            size_t tile = TileIndex((size_t)(c - g_cells.data()));
+            POINT o = BoxOrigin(*c);
+            BlitCoverage(bits, stride, g_w, g_h, o.x, o.y, &g_tiles[tile * g_tileW * g_tileH * 2], g_tileW, g_tileH, CELL_COLOR,
+                         TEXT_COLOR);
+            add(o.x, o.y, g_boxW[tile], g_tileH);
+        }
+        if (HasPrompt()) {
+            RECT pr = PromptRect(g_filtered[0]->rc, { 0, 0, g_w, g_h }, g_fontScale);
+            int pw = pr.right - pr.left, ph = pr.bottom - pr.top;
+            std::vector<uint8_t> masks((size_t)pw * ph * 2, 0);
+            RasterizePrompt(PROMPT_TEXT, g_fontScale, masks.data(), pw, ph);
+            BlitCoverage(bits, stride, g_w, g_h, pr.left, pr.top, masks.data(), pw, ph, PROMPT_COLOR, TEXT_COLOR);
+            add(pr.left, pr.top, pw, ph);
+        }
+    }
+    box = { std::max(box.left, 0L), std::max(box.top, 0L), std::min(box.right, (LONG)g_w), std::min(box.bottom, (LONG)g_h) };
+    if (box.right <= box.left || box.bottom <= box.top) box = { 0, 0, 0, 0 };
+
+    RECT dirty = g_drawn; // Old and new areas
+    if (box.right > box.left) {
+        if (dirty.right <= dirty.left) dirty = box;
+        dirty = { std::min(dirty.left, box.left), std::min(dirty.top, box.top), std::max(dirty.right, box.right),
+                  std::max(dirty.bottom, box.bottom) };
+    }
+    g_drawn = box;
+    if (!g_composited) // Only the boxes are part of the window
+        XShapeCombineRectangles(g_dpy, g_win, ShapeBounding, 0, 0, shape.data(), (int)shape.size(), ShapeSet, Unsorted);
+    if (dirty.right > dirty.left) {
+        int x = dirty.left, y = dirty.top, w = dirty.right - dirty.left, h = dirty.bottom - dirty.top;
+        if (g_useShm) XShmPutImage(g_dpy, g_win, g_gc, g_image, x, y, x, y, w, h, False);
+        else XPutImage(g_dpy, g_win, g_gc, g_image, x, y, x, y, w, h);
+    }
+    XSync(g_dpy, False); // The server reads shared memory asynchronously: done before the next frame writes it
+}
+
+// --- Input ---
+
+static POINT CursorPos() {
+    Window r, child;
+    int x = 0, y = 0, wx, wy;
+    unsigned mask;
+    XQueryPointer(g_dpy, g_root, &r, &child, &x, &y, &wx, &wy, &mask);
+    return { x, y };
+}
+
+static void MoveCursor(POINT pt) {
+    if (g_xtest.motion) g_xtest.motion(g_dpy, -1, (int)pt.x, (int)pt.y, 0);
+    else XWarpPointer(g_dpy, 0, g_root, 0, 0, 0, 0, (int)pt.x, (int)pt.y);
+    XFlush(g_dpy);
+}
+
+// Deliver a planned action with XTest; each event carries its pause, which the server applies
+static void Perform(const InputAction& action) {
+    if (!g_xtest.motion) { fprintf(stderr, "Vimerate: mouse actions need libXtst\n"); return; }
+    std::vector<InputEvent> plan;
+    PlanInput(action, plan);
+    for (const InputEvent& e : plan) {
+        unsigned long delay = (unsigned long)e.delayMs;
+        switch (e.type) {
+        case EV_MOVE: g_xtest.motion(g_dpy, -1, (int)e.pt.x, (int)e.pt.y, delay); break;
+        case EV_BUTTON_DOWN:
+        case EV_BUTTON_UP: {
+            unsigned button = e.button == BTN_RIGHT ? 3 : e.button == BTN_MIDDLE ? 2 : 1;
+            g_xtest.button(g_dpy, button, e.type == EV_BUTTON_DOWN, delay);
+            break;
+        }
+        case EV_WHEEL: { // A notch is a press and release of a wheel button
+            unsigned button = e.horizontal ? (e.notches > 0 ? 7 : 6) : (e.notches > 0 ? 4 : 5);
+            g_xtest.button(g_dpy, button, True, delay);
+            g_xtest.button(g_dpy, button, False, 0);
+            break;
+        }
+        case EV_KEY_DOWN:
+        case EV_KEY_UP: {
+            KeySym sym = e.modifier == MOD_CONTROL ? XK_Control_L : e.modifier == MOD_SHIFT ? XK_Shift_L
+                       : e.modifier == MOD_ALT ? XK_Alt_L : XK_Super_L;
+            g_xtest.key(g_dpy, XKeysymToKeycode(g_dpy, sym), e.type == EV_KEY_DOWN, delay);
+            break;
+        }
+        }
+    }
+    XFlush(g_dpy);
+}
+
+static void ShowGrid() {
+    g_grid.Show();
+    POINT focus = CursorPos(); // Foveation centers on where the user is working
+    LayoutCells(g_foveated ? &focus : nullptr);
+    FilterCells();
+    XMapRaised(g_dpy, g_win);
+    for (int i = 0; i < 20; ++i) { // Another client may hold the keyboard for a moment after the hotkey
+        if (XGrabKeyboard(g_dpy, g_win, False, GrabModeAsync, GrabModeAsync, CurrentTime) == GrabSuccess) break;
+        usleep(5000);
+    }
+    Present();
+}
+
+static void HideGrid() {
+    g_grid.state = HIDDEN;
+    XUngrabKeyboard(g_dpy, CurrentTime);
+    Present(); // Clears the drawn area, so the next show doesn't flash this grid
+    XUnmapWindow(g_dpy, g_win);
+    XFlush(g_dpy);
+}
+
+// Translate a key press for GridSession: the click prompt reads letters and digits by key position,
+// typing reads the character the key produces
+static GridKey TranslateKey(XKeyEvent& e, wchar_t& ch) {
+    ch = 0;
+    KeySym sym = XLookupKeysym(&e, 0); // Unshifted: the key's position
+    switch (sym) {
+    case XK_Escape:    return GKEY_ESCAPE;
+    case XK_BackSpace: return GKEY_BACKSPACE;
+    case XK_Left:      return GKEY_LEFT;
+    case XK_Right:     return GKEY_RIGHT;
+    case XK_Up:        return GKEY_UP;
+    case XK_Down:      return GKEY_DOWN;
+    }
+    if (g_grid.state == WAIT_CLICK) {
+        if ((sym >= XK_0 && sym <= XK_9) || (sym >= XK_a && sym <= XK_z)) { ch = (wchar_t)sym; return GKEY_CHAR; }
+        return GKEY_OTHER;
+    }
+    char buf[8];
+    KeySym typed;
+    if (XLookupString(&e, buf, sizeof(buf), &typed, nullptr) != 1) return GKEY_OTHER;
+    ch = (wchar_t)(unsigned char)buf[0];
+    return GKEY_CHAR;
+}
+
+static void HandleKey(XKeyEvent& e) {
+    if (e.keycode == g_hotkeyCode && (e.state & MODIFIER_MASK) == HOTKEY_MODS) { // The hotkey toggles the grid
+        if (g_grid.state == HIDDEN) ShowGrid(); else HideGrid();
+        return;
+    }
+    wchar_t ch;
+    GridKey key = TranslateKey(e, ch);
+    GridResult r = g_grid.Key(key, ch); // Core/Grid.h decides; this carries it out
+    switch (r.step) {
+    case STEP_HIDE:
+        HideGrid();
+        break;
+    case STEP_SCROLL: // The input shape lets the wheel reach the window under the cursor
+        Perform(r.action);
+        break;
+    case STEP_NUDGE: {
+        POINT pt = CursorPos();
+        MoveCursor({ pt.x + r.dx, pt.y + r.dy });
+        break;
+    }
+    case STEP_DRAG_START:
+        g_grid.dragFrom = CursorPos();
+        FilterCells();
+        Present();
+        break;
+    case STEP_ACT: // Hide and release the keyboard first: the action is for the window underneath
+        HideGrid();
+        Perform(r.action);
+        break;
+    case STEP_FILTER:
+    case STEP_LOOKUP: {
+        FilterCells();
+        Cell* hit = nullptr;
+        for (Cell* c : g_filtered)
+            if (r.step == STEP_LOOKUP && c->lbl == g_grid.typed) { hit = c; break; }
+        if (!hit) { Present(); break; }
+        GridResult sel = g_grid.Select(hit->pt);
+        if (sel.step == STEP_ACT) { // Drop point chosen: one paced drag
+            HideGrid();
+            Perform(sel.action);
+        } else {
+            MoveCursor(hit->pt);
+            Present(); // The prompt next to the selected cell
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static void HandleEvent(XEvent& ev) {
+    if (ev.type == KeyPress) HandleKey(ev.xkey);
+    else if (ev.type == Expose && ev.xexpose.window == g_win && g_grid.state != HIDDEN) {
+        const XExposeEvent& x = ev.xexpose;
+        if (g_useShm) XShmPutImage(g_dpy, g_win, g_gc, g_image, x.x, x.y, x.x, x.y, x.width, x.height, False);
+        else XPutImage(g_dpy, g_win, g_gc, g_image, x.x, x.y, x.x, x.y, x.width, x.height);
+        XSync(g_dpy, False);
+    }
+}
+
+// Grab the hotkey on the root window, with and without Caps Lock and Num Lock
+static bool GrabHotkey() {
+    g_hotkeyCode = XKeysymToKeycode(g_dpy, HOTKEY_KEY);
+    g_xError = 0;
+    XErrorHandler old = XSetErrorHandler(RecordXError);
+    for (unsigned locks : { 0u, (unsigned)LockMask, (unsigned)Mod2Mask, (unsigned)(LockMask | Mod2Mask) })
+        XGrabKey(g_dpy, g_hotkeyCode, HOTKEY_MODS | locks, g_root, True, GrabModeAsync, GrabModeAsync);
+    XSync(g_dpy, False);
+    XSetErrorHandler(old);
+    return g_xError == 0;
+}
+
+// --- Command socket ---
+// The command pipe's protocol on a Unix socket (opt-in: --command-socket). Served on the main
+// thread between X events, one client at a time like the pipe; labels resolve on the uniform
+// full-screen grid, whatever the overlay shows.
+
+int         g_listenFd = -1;  // Listening socket, or -1
+int         g_clientFd = -1;  // Connected client, or -1
+std::string g_pending;        // Client bytes after the last complete line
+
+static void SocketMove(POINT pt) { MoveCursor(pt); }
+static void SocketPerform(const InputAction& action) { Perform(action); }
+static const CommandActions SOCKET_ACTIONS = { SocketMove, SocketPerform };
+
+// $XDG_RUNTIME_DIR/vimerate.sock (private to the user), else a per-user name in /tmp
+static std::string CommandSocketPath() {
+    const char* dir = getenv("XDG_RUNTIME_DIR");
+    if (dir && *dir) return std::string(dir) + "/vimerate.sock";
+    return "/tmp/vimerate-" + std::to_string(getuid()) + ".sock";
+}
+
+// Listen on 'path'. Fails if another instance answers there; a stale socket file is replaced.
+static bool StartCommandSocket(const std::string& path) {
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    bool owned = probe >= 0 && connect(probe, (sockaddr*)&addr, sizeof(addr)) == 0;
+    if (probe >= 0) close(probe);
+    if (owned) return false;
+    unlink(path.c_str()); // Left by an instance that was killed
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    mode_t old = umask(0077); // Owner only, even in /tmp
+    bool ok = fd >= 0 && bind(fd, (sockaddr*)&addr, sizeof(addr)) == 0 && listen(fd, 1) == 0;
+    umask(old);
+    if (!ok) { if (fd >= 0) close(fd); return false; }
+    g_listenFd = fd;
+    return true;
+}
+
+// The socket select() reported: accept a client, or run its complete lines and write the replies
+// back in one go. A client that hangs up or stops reading is dropped.
+static void ServeCommandSocket() {
+    if (g_clientFd < 0) {
+        g_clientFd = accept4(g_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        g_pending.clear();
+        return;
+    }
+    char buf[16384];
+    ssize_t n = read(g_clientFd, buf, sizeof(buf));
+    std::string reply;
+    if (n > 0) {
+        g_pending.append(buf, (size_t)n);
+        ExecuteCommandBatch(g_pending, g_poolSize, { 0, 0, g_w, g_h }, SOCKET_ACTIONS, reply);
+    }
+    for (size_t sent = 0; n > 0 && sent < reply.size(); ) {
+        ssize_t k = send(g_clientFd, reply.data() + sent, reply.size() - sent, MSG_NOSIGNAL); // No SIGPIPE on hang-up
+        if (k <= 0) n = -1; else sent += (size_t)k;
+    }
+    if (n <= 0) { close(g_clientFd); g_clientFd = -1; }
+}
+
+// Handle X events and command socket traffic until the process is stopped
+static void RunEventLoop() {
+    for (;;) {
+        while (XPending(g_dpy)) {
+            XEvent ev;
+            XNextEvent(g_dpy, &ev);
+            HandleEvent(ev);
+        }
+        int xfd = ConnectionNumber(g_dpy), sock = g_clientFd >= 0 ? g_clientFd : g_listenFd;
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(xfd, &fds);
+        if (sock >= 0) FD_SET(sock, &fds);
+        if (select(std::max(xfd, sock) + 1, &fds, nullptr, nullptr, nullptr) > 0 && sock >= 0 && FD_ISSET(sock, &fds))
+            ServeCommandSocket();
+    }
+}
+
+// --- Self-test ---
+// Drives the real window with XTest keys, as a user would, and checks where the cursor lands and
+// what the window shows. Needs an X server (Xvfb in CI) and libXtst.
+
+// Handle events until 'done' holds or 'ms' pass
+template <class Done> static bool PumpUntil(int ms, Done done) {
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    while (!done()) {
+        while (XPending(g_dpy)) {
+            XEvent ev;
+            XNextEvent(g_dpy, &ev);
+            HandleEvent(ev);
+        }
+        if (done()) break;
+        auto left = std::chrono::duration_cast<std::chrono::microseconds>(end - std::chrono::steady_clock::now()).count();
+        if (left <= 0) return false;
+        int fd = ConnectionNumber(g_dpy);
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(fd, &fds);
+        timeval tv = { (time_t)(left / 1000000), (suseconds_t)(left % 1000000) };
+        select(fd + 1, &fds, nullptr, nullptr, &tv);
+    }
+    return true;
+}
+
+static void TypeKey(KeySym sym) {
+    KeyCode code = XKeysymToKeycode(g_dpy, sym);
+    g_xtest.key(g_dpy, code, True, 0);
+    g_xtest.key(g_dpy, code, False, 0);
+    XFlush(g_dpy);
+}
+
+// Pixel of the window as the server holds it, as straight 0xAARRGGBB of the premultiplied value
+static uint32_t WindowPixel(int x, int y) {
+    XImage* img = XGetImage(g_dpy, g_win, x, y, 1, 1, AllPlanes, ZPixmap);
+    if (!img) return 0;
+    uint32_t v = (uint32_t)XGetPixel(img, 0, 0);
+    XDestroyImage(img);
+    return v;
+}
+
+static uint32_t Premultiplied(uint32_t c) {
+    int a = c >> 24;
+    return (uint32_t)a << 24 | (uint32_t)Mul255((c >> 16) & 0xFF, a) << 16 | (uint32_t)Mul255((c >> 8) & 0xFF, a) << 8 |
+           (uint32_t)Mul255(c & 0xFF, a);
+}
+
+static int SelfTest() {
+    int failures = 0;
+    auto check = [&](bool ok, const char* what) {
+        if (!ok) { ++failures; fprintf(stderr, "x11 self-test: %s\n", what); }
+        return ok;
+    };
+    if (!check(g_xtest.key != nullptr, "libXtst is not available")) return 1;
+    MoveCursor({ 1, 1 });
+    ShowGrid();
+    check(g_filtered.size() == g_cells.size(), "the grid did not open with every label");
+    POINT aa = BoxOrigin(g_cells[0]); // Left edge of the first box, halfway down: box only, no text
+    check(WindowPixel(aa.x, aa.y + g_tileH / 2) == Premultiplied(CELL_COLOR), "the first label box is not drawn");
+
+    TypeKey(XK_a);
+    TypeKey(XK_b);
+    check(PumpUntil(2000, [] { return g_grid.state == WAIT_CLICK; }), "typing 'ab' did not select a cell");
+    RECT rc;
+    LabelRect(L"ab", g_poolSize, { 0, 0, g_w, g_h }, rc);
+    POINT want = { (rc.left + rc.right) / 2, (rc.top + rc.bottom) / 2 };
+    PumpUntil(1000, [&] { POINT p = CursorPos(); return p.x == want.x && p.y == want.y; });
+    POINT got = CursorPos();
+    check(got.x == want.x && got.y == want.y, "the cursor is not at the center of 'ab'");
+    RECT pr = PromptRect(rc, { 0, 0, g_w, g_h }, g_fontScale);
+    check(WindowPixel(pr.left + 2, (pr.top + pr.bottom) / 2) == PROMPT_COLOR, "the click prompt is not drawn");
+
+    TypeKey(XK_1); // Left click, then the grid closes
+    check(PumpUntil(2000, [] { return g_grid.state == HIDDEN; }), "'1' did not close the grid");
+    XWindowAttributes wa;
+    XGetWindowAttributes(g_dpy, g_win, &wa);
+    check(wa.map_state == IsUnmapped, "the overlay is still mapped");
+
+    if (failures) return 1;
+    printf("x11 self-test: passed (%s, %s)\n", g_useShm ? "MIT-SHM" : "XPutImage", g_composited ? "composited" : "shaped");
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    bool selfTest = false, commandSocket = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--pool") == 0 && i + 1 < argc)
+            g_poolSize = std::max(MIN_POOL_SIZE, std::min(atoi(argv[++i]), (int)POOL.length()));
+        else if (strcmp(argv[i], "--foveated") == 0) g_foveated = true;
+        else if (strcmp(argv[i], "--self-test") == 0) selfTest = true;
+        else if (strcmp(argv[i], "--command-socket") == 0) commandSocket = true;
+        else {
+            fprintf(stderr, "usage: %s [--pool N] [--foveated] [--command-socket] [--self-test]\n", argv[0]);
+            return 2;
+        }
+    }
+    g_dpy = XOpenDisplay(nullptr);
+    if (!g_dpy) { fprintf(stderr, "Vimerate: cannot open the X display\n"); return 1; }
+    LoadXTest();
+    if (!CreateOverlay()) return 1;
+    BuildTiles();
+    GenerateCells();
+    if (selfTest) return SelfTest();
+
+    if (!GrabHotkey()) { fprintf(stderr, "Vimerate: Super+Shift+Z is taken by another program\n"); return 1; }
+    if (!g_xtest.motion) fprintf(stderr, "Vimerate: libXtst not found; jumps move the cursor, mouse actions are off\n");
+    if (commandSocket && !StartCommandSocket(CommandSocketPath()))
+        fprintf(stderr, "Vimerate: command socket %s unavailable (another instance?)\n", CommandSocketPath().c_str());
+    RunEventLoop();
+}